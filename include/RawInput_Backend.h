@@ -4,11 +4,48 @@
 #include <hidsdi.h>
 #include <hidpi.h>
 #include <stdint.h>
+#include <ds4Sensors.h>
+#include <fastDecode.h>
+#include <math.h>
+#include <arena.h>
 
 #define MAX_USAGES 128
 #define HID_MAP_UNUSED -1
 #define DEADZONE 0.15f
 
+static inline float applyDeadzone(float v, float dz) {
+    if (fabsf(v) < dz)
+        return 0.0f;
+
+    // Rescale so we still reach ±1
+    if (v > 0.0f)
+        return (v - dz) / (1.0f - dz);
+    else
+        return (v + dz) / (1.0f - dz);
+}
+
+// Logical range -> [-1, 1] with deadzone. Shared by the generic and fast decoders so both agree bit for bit.
+static inline float hid_normalize_axis(LONG value, LONG logicalMin, LONG logicalMax) {
+    float norm = (float)(value - logicalMin) / (float)(logicalMax - logicalMin);
+    norm = norm * 2.0f - 1.0f;
+    return applyDeadzone(norm, DEADZONE);
+}
+
+// Hat switch value (0 = up, clockwise) -> DPAD bits, anything else is neutral
+static inline uint32_t hid_hat_to_dpad(LONG hat) {
+    switch (hat) {
+        case 0: return BTN_DPAD_UP;
+        case 1: return BTN_DPAD_UP | BTN_DPAD_RIGHT;
+        case 2: return BTN_DPAD_RIGHT;
+        case 3: return BTN_DPAD_DOWN | BTN_DPAD_RIGHT;
+        case 4: return BTN_DPAD_DOWN;
+        case 5: return BTN_DPAD_DOWN | BTN_DPAD_LEFT;
+        case 6: return BTN_DPAD_LEFT;
+        case 7: return BTN_DPAD_UP | BTN_DPAD_LEFT;
+        default: return 0;
+    }
+}
+
 typedef struct {
     int mappedEnum;   // INPUT_AXIS_LEFT_X, INPUT_AXIS_RT, etc
     int axisIndex;    // SDL / logical axis index (0,1,2,…)
@@ -28,7 +65,10 @@ typedef struct {
 } DpadMapping;
 
 
-// Creates a device record that we call once per device. caps are short for capabilities.
+/* Everything needed to decode one device model: preparsed data, caps and the
+resolved DB mapping. Identical pads share a single layout, which is immutable
+once built and reference counted by the HidRecords that use it. caps are short
+for capabilities. */
 typedef struct {
     // Buttons
     ButtonMapping buttons[MAX_USAGES];
@@ -48,18 +88,85 @@ typedef struct {
     uint16_t vendorID;
     uint16_t productID;
 
-    // HID info
-    HANDLE device;
+    // HID info, all three buffers live in arena
+    Arena arena;
     PHIDP_PREPARSED_DATA preparsed;
+    UINT preparsedSize;
     HIDP_CAPS caps;
     HIDP_BUTTON_CAPS *buttonCaps;
     USHORT buttonCapCount;
     HIDP_VALUE_CAPS *valueCaps;
     USHORT valueCapCount;
 
+    // Specialized decoder, entry is NULL for the generic path
+    FastDecoder fast;
+
+    // Sharing key and users
+    uint64_t descriptorHash;
+    int refCount;
+} HidLayout;
+
+// Record lifecycle. WndProc moves FREE -> PENDING and READY/FAILED -> RETIRING,
+// the registration worker does everything else.
+typedef enum {
+    DEV_FREE,
+    DEV_PENDING,    // queued for registration, reports are dropped
+    DEV_READY,      // layout published, reports are parsed
+    DEV_FAILED,     // registration failed, kept so we don't retry every report
+    DEV_RETIRING    // unplugged, waiting for the worker to release the layout
+} DevStatus;
+
+/* Raw reports waiting for a decode worker. WndProc is the only producer and
+the device's shard the only consumer, head and tail sit on their own cache
+lines so the two sides don't fight over them. Slots are sized from the
+device's InputReportByteLength when it registers, which is what RawInput
+hands us as dwSizeHid: 64 bytes for a DS4 over USB, 547 over Bluetooth. */
+#define REPORT_QUEUE_DEPTH 32
+
+typedef struct {
+    unsigned head __attribute__((aligned(64)));    // written by the decode worker
+    unsigned tail __attribute__((aligned(64)));    // written by WndProc
+    UINT slotBytes;
+    UINT size[REPORT_QUEUE_DEPTH];
+    BYTE *data;                                    // REPORT_QUEUE_DEPTH slots of slotBytes
+} ReportQueue;
+
+// Creates a device record that we call once per device.
+typedef struct {
+    LONG status;    // DevStatus, read and written atomically
+    HANDLE device;
+    uint16_t vendorID;
+    uint16_t productID;
+    int xinputInterface;    // IG_xx from the device path, -1 for plain HID devices
+    LONG suppressed;        // the same pad is being decoded by XInput, skip its reports
+    const HidLayout *layout;
+
+    // Motion sensors (DualShock 4 only)
+    int hasImu;
+    Ds4ImuFilter imu;
+
     GamepadState *state;
+    int soakStarted;        // a report has come in, soak samples the slot every frame (message thread only)
+
+    // Threaded decode only: state points at shadow, which the owning worker
+    // publishes to the message thread under publishSeq (odd while writing)
+    ReportQueue queue;
+    GamepadState shadow;
+    GamepadState published;
+    uint32_t publishSeq;
+    uint32_t readSeq;       // last publishSeq rawUpdate saw, message thread only
+    LONG decodeAck;         // worker has let go of a RETIRING record
 } HidRecord;
 
+void parseReport(HidRecord *dev, const BYTE *report, UINT size);
+// Generic HidP decode, the reference the fast decoders are checked against
+void hid_decode_generic(const HidLayout *layout, const BYTE *report, UINT size, GamepadState *g);
+
+void rawinput_set_decode_threads(int threads);
 void rawInit(void);
+void rawShutdown(void);
 void rawUpdate(void);
-const GamepadState *rawinput_get_gamepad(int index);
\ No newline at end of file
+const GamepadState *rawinput_get_gamepad(int index);
+int rawinput_get_identity(int index, DeviceIdentity *out);
+unsigned rawinput_get_dropped(void);
+void rawinput_set_suppressed(int index, int suppressed);
\ No newline at end of file
@@ -3,7 +3,11 @@
 #include <windows.h>
 #include <math.h>
 #include <xinput.h>
+#include <xinputPoller.h>
 
 void xinput_init();
 void xinput_update();
-const GamepadState *xinput_get_gamepad(int index);
\ No newline at end of file
+void xinput_shutdown();
+const GamepadState *xinput_get_gamepad(int index);
+void xinput_set_get_state(XPollGetStateFn getState);
+int xinput_get_identity(int index, DeviceIdentity *out);
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+/* Allocation audit for soak runs. Built with -DALLOC_AUDIT and the linker
+wraps in the makefile's audit target, every malloc/calloc/realloc/free in our
+own code is counted. Once a thread declares itself steady, any allocation on
+that thread aborts with a message. Registration runs on its own thread and is
+allowed to allocate. Without ALLOC_AUDIT the macros compile to nothing. */
+
+#ifdef ALLOC_AUDIT
+
+void alloc_audit_steady(void);
+void alloc_audit_report(void);
+
+#define ALLOC_AUDIT_STEADY() alloc_audit_steady()
+#define ALLOC_AUDIT_REPORT() alloc_audit_report()
+
+#else
+
+#define ALLOC_AUDIT_STEADY() ((void)0)
+#define ALLOC_AUDIT_REPORT() ((void)0)
+
+#endif
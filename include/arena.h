@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Bump allocator over a single malloc'd block. Everything carved from it is
+released together by arena_free, so an object with several buffers costs one
+allocation and one free. */
+
+#define ARENA_ALIGN 16
+
+typedef struct {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+} Arena;
+
+static inline size_t arena_round(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static inline int arena_init(Arena *a, size_t size) {
+    a->base = malloc(size);
+    a->size = a->base ? size : 0;
+    a->used = 0;
+    return a->base ? 0 : -1;
+}
+
+// Returns NULL when the block is exhausted, callers size the arena up front
+static inline void *arena_alloc(Arena *a, size_t size) {
+    size = arena_round(size);
+    if (a->used + size > a->size)
+        return NULL;
+    void *p = a->base + a->used;
+    a->used += size;
+    return p;
+}
+
+static inline void arena_free(Arena *a) {
+    free(a->base);
+    a->base = NULL;
+    a->size = 0;
+    a->used = 0;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <input.h>
+
+/* In-memory copy of the SDL game controller DB with a hash index on VID/PID.
+Nothing in here touches Windows or a device, so the same lookup that
+buildHIDMap uses can resolve a whole inventory of GUIDs on any machine. */
+
+#define CDB_DEFAULT_PATH "gamecontrollerdb.txt"
+#define CDB_PLATFORM "Windows"      // lines for the platform we run on win over earlier ones
+
+#define CDB_MAX_AXES 16
+#define CDB_MAX_BUTTONS 32
+#define CDB_MAX_UNSUPPORTED 48
+
+// Points into the DB buffer, not NUL terminated
+typedef struct {
+    const char *text;
+    int length;
+} CdbToken;
+
+typedef struct {
+    int mappedEnum;     // InputAxis
+    int sdlAxis;        // a0, a1, ...
+    uint16_t usage;     // HID Generic Desktop usage the SDL axis stands for
+    int inverted;       // a<n>~, the decoder maps it but doesn't flip it
+    CdbToken token;
+} CdbAxis;
+
+typedef struct {
+    int mappedEnum;     // InputButton
+    int buttonIndex;    // b0, b1, ...
+    CdbToken token;
+} CdbButton;
+
+// What the tool does with one DB line
+typedef struct {
+    CdbToken guid;
+    CdbToken name;
+    CdbToken platform;  // empty if the line has no platform field
+    int platformMatch;  // line is for CDB_PLATFORM
+
+    CdbAxis axes[CDB_MAX_AXES];
+    int axisCount;
+    CdbButton buttons[CDB_MAX_BUTTONS];
+    int buttonCount;
+    int hatDpad;        // the dpad entries agree with the fixed hat mapping we decode with
+
+    // Tokens the tool ignores (guide, touchpad, half axes, ...)
+    CdbToken unsupported[CDB_MAX_UNSUPPORTED];
+    int unsupportedCount;
+} CdbMapping;
+
+typedef struct {
+    uint32_t key;       // VID << 16 | PID
+    int platformMatch;
+    const char *line;
+    int next;           // next entry in the same bucket, -1 ends the chain
+} CdbEntry;
+
+typedef struct {
+    char *text;         // the whole file, lines NUL terminated in place
+    CdbEntry *entries;
+    int entryCount;
+    int *buckets;       // first entry per bucket, -1 if empty
+    uint32_t bucketMask;
+} ControllerDb;
+
+int cdb_load(ControllerDb *db, const char *path);
+void cdb_free(ControllerDb *db);
+
+void parse_vid_pid(const char *guid, uint16_t *vid, uint16_t *pid);
+
+// Line the tool would use for this VID/PID, NULL if the DB doesn't know it
+const char *cdb_find(const ControllerDb *db, uint16_t vendorID, uint16_t productID);
+int cdb_resolve(const ControllerDb *db, uint16_t vendorID, uint16_t productID, CdbMapping *out);
+
+// Accepts an SDL GUID or a VID:PID pair in hex, returns 0 if it is neither
+int cdb_parse_query(const char *text, uint16_t *vendorID, uint16_t *productID);
+
+// One output line per query line of in, returns the number of queries resolved
+int cdb_resolve_batch(const ControllerDb *db, FILE *in, FILE *out);
@@ -0,0 +1,24 @@
+#pragma once
+#include <RawInput_Backend.h>
+
+/* Parallel report decoding. Devices are sharded over a few worker threads by
+slot (slot % threads), and each shard is the only thread that ever decodes its
+devices, so HidRecords need no locks. WndProc copies every report into the
+device's single-producer/single-consumer queue and moves on. Decoded state
+goes back to the message thread through a per-device seqlock. */
+
+#define DECODE_MAX_THREADS 16
+#define DECODE_SPIN_PASSES 64    // empty passes before a worker goes to sleep
+
+int decode_pool_start(int threads, HidRecord *records, int count);
+void decode_pool_stop(void);
+int decode_pool_active(void);
+
+// Registration worker side: queue slots sized for the device, freed after the worker acks
+int decode_pool_attach(HidRecord *dev, UINT reportBytes);
+void decode_pool_detach(HidRecord *dev);
+
+// Message thread side
+int decode_pool_push(HidRecord *dev, const BYTE *report, UINT size);
+void decode_pool_wake(HidRecord *dev);
+void decode_pool_read(HidRecord *dev, GamepadState *out, uint32_t *lastSeq);
@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+#include <input.h>
+
+/* DualShock 4 motion sensor decoding. Works on the raw report bytes only, so it
+has no Windows dependency and can be fed captured reports on any platform. */
+
+#define DS4_VENDOR_ID     0x054C
+#define DS4_PRODUCT_ID_V1 0x05C4
+#define DS4_PRODUCT_ID_V2 0x09CC
+
+// Report IDs that carry the full input block (USB and Bluetooth)
+#define DS4_REPORT_USB 0x01
+#define DS4_REPORT_BT  0x11
+
+// Orientation filter state, angles are Q16.16 degrees
+typedef struct {
+    int32_t pitch;
+    int32_t roll;
+    int32_t yaw;
+    uint16_t lastTimestamp;
+    int primed;
+} Ds4ImuFilter;
+
+int ds4_is_device(uint16_t vendorID, uint16_t productID);
+void ds4_imu_reset(Ds4ImuFilter *f);
+
+// Returns 1 and fills out when the report carried IMU data, 0 otherwise
+int ds4_imu_decode(Ds4ImuFilter *f, const uint8_t *report, uint32_t size, GamepadSensors *out);
@@ -0,0 +1,58 @@
+#pragma once
+#include <stdint.h>
+#include <input.h>
+
+/* Fast-path decoders for controllers we run in bulk. Each one is built from a
+compile-time layout (fixed report offsets), so parsing a report is a handful of
+byte loads and table lookups instead of HidP calls. fast_bind() checks the
+layout against the device's caps and the DB mapping, and leaves the device on
+the generic path if anything doesn't line up. */
+
+#define FAST_AXIS_SLOTS   6      // Generic Desktop X, Y, Z, Rx, Ry, Rz
+#define FAST_NO_FIELD     0xFF
+#define FAST_BUTTON_BYTES 4      // up to 32 HID buttons
+#define FAST_MAX_AXIS_MAPS 16
+
+typedef struct {
+    uint8_t  reportID;                      // first byte of every report (0 if the device has none)
+    uint16_t reportLength;                  // expected caps.InputReportByteLength
+    uint8_t  axisOffset[FAST_AXIS_SLOTS];   // byte offset of each 8-bit axis, FAST_NO_FIELD if absent
+    uint8_t  hatOffset;                     // hat switch in the low nibble of this byte
+    uint16_t buttonBit;                     // bit offset of HID button 1
+    uint8_t  buttonCount;
+} FastLayout;
+
+typedef struct FastDecoderEntry FastDecoderEntry;
+
+typedef struct {
+    uint8_t slot;        // FAST_AXIS_SLOTS index
+    uint8_t mappedEnum;  // INPUT_AXIS_*
+} FastAxisMap;
+
+// Decoder state for one device model, resolved when its layout is built
+typedef struct {
+    const FastDecoderEntry *entry;          // NULL when the device uses the generic path
+    int axisMapCount;
+    FastAxisMap axisMap[FAST_MAX_AXIS_MAPS];
+    int useHat;
+    uint32_t buttonLut[FAST_BUTTON_BYTES][256];  // raw button byte -> GamepadBitmask bits
+} FastDecoder;
+
+typedef void (*FastDecodeFn)(const FastDecoder *d, const uint8_t *report, GamepadState *g);
+
+struct FastDecoderEntry {
+    uint16_t vendorID;
+    uint16_t productID;
+    const char *name;
+    const FastLayout *layout;
+    FastDecodeFn decode;
+};
+
+// Returns 1 if the report was decoded, 0 if it must go through the generic path
+static inline int fast_decode(const FastDecoder *d, const uint8_t *report, uint32_t size, GamepadState *g) {
+    const FastLayout *L = d->entry->layout;
+    if (size < L->reportLength || report[0] != L->reportID)
+        return 0;
+    d->entry->decode(d, report, g);
+    return 1;
+}
@@ -17,4 +17,11 @@
 #define HID_USAGE_RZ                    0x35
 #define HID_USAGE_HAT_SWITCH            0x39
 
-void buildHIDMap(HidRecord *dev);
\ No newline at end of file
+void buildHIDMap(HidLayout *layout);
+
+// Picks a compile-time fast decoder for known VID/PIDs, returns 0 to stay on the generic path
+int fast_bind(HidLayout *layout);
+
+// Shared decode layouts, one per distinct device model (VID/PID + descriptor hash)
+const HidLayout *layout_acquire(HANDLE device, uint16_t vendorID, uint16_t productID);
+void layout_release(const HidLayout *layout);
\ No newline at end of file
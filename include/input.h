@@ -1,7 +1,9 @@
 #pragma once
 #include <stdint.h>
 
-#define MAX_CONTROLLERS 4
+#define MAX_CONTROLLERS 4    // XInput slots
+#define MAX_HID_DEVICES 32   // RawInput devices tracked at once
+#define MAX_PADS (MAX_CONTROLLERS + MAX_HID_DEVICES)   // merged table behind input_get_gamepad
 #define MAP_UNUSED -1
 
 typedef enum {
@@ -57,12 +59,40 @@ typedef enum {
     BTN_DPAD_RIGHT = 1 << INPUT_DPAD_RIGHT
 } GamepadBitmask;
 
+// Motion sensors, only filled in by devices that report them (DualShock 4)
+typedef struct {
+    int present;
+    int16_t gyro[3];   // raw pitch/yaw/roll rates
+    int16_t accel[3];  // raw x/y/z
+    float pitch;       // filtered orientation in degrees
+    float roll;
+    float yaw;
+} GamepadSensors;
+
 typedef struct {
     int connected;
     float axes[INPUT_AXIS_COUNT];
     uint32_t buttons; 
+    GamepadSensors sensors;
 } GamepadState;
 
+typedef enum {
+    INPUT_BACKEND_NONE,
+    INPUT_BACKEND_RAW,
+    INPUT_BACKEND_XINPUT
+} InputBackend;
+
+// Who a device is, used to spot the same pad showing up in both backends
+typedef struct {
+    uint16_t vendorID;      // 0 when the backend can't tell
+    uint16_t productID;
+    int xinputInterface;    // IG_xx from the HID path, -1 if this isn't an XInput device's HID side
+} DeviceIdentity;
+
+void input_set_decode_threads(int threads);
+unsigned input_dropped_reports(void);
 void input_init(void);
+void input_shutdown(void);
 void input_update(void);
-const GamepadState *input_get_gamepad(int index);
\ No newline at end of file
+const GamepadState *input_get_gamepad(int index);
+InputBackend input_get_backend(int index);
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <input.h>
+
+/* Shared-memory publication of controller state. The tool writes every slot
+into a named segment, external readers map the same segment read-only.
+Each slot is guarded by a seqlock: the writer bumps seq to odd, writes, then
+bumps it back to even, so readers never block the writer and never make a
+syscall to read. This header plus padShmReader.c is the whole reader library. */
+
+#define PADSHM_MAGIC 0x53444150u   // "PADS"
+#define PADSHM_VERSION 1
+#define PADSHM_DEFAULT_NAME "cdebug_pads"
+
+// Slots sit on their own cache lines so one pad updating doesn't stall readers of another
+typedef struct {
+    uint32_t seq;          // seqlock word, odd while a write is in progress
+    uint32_t reserved;
+    uint64_t sequence;     // number of times this slot has been published
+    uint64_t timestampUs;  // monotonic clock (QPC / CLOCK_MONOTONIC) at publish time
+    GamepadState state;
+} __attribute__((aligned(64))) PadShmSlot;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;     // sizeof(PadShmSlot) of the writer, readers check it matches
+    PadShmSlot slots[];
+} __attribute__((aligned(64))) PadShmHeader;
+
+// A consistent copy of one slot
+typedef struct {
+    uint64_t sequence;
+    uint64_t timestampUs;
+    GamepadState state;
+} PadShmSnapshot;
+
+// Writer side, used by the tool
+int padshm_publish_open(const char *name, int slotCount);
+void padshm_publish(int slot, const GamepadState *state);
+void padshm_publish_close(void);
+
+// Reader side
+typedef struct PadShmReader PadShmReader;
+
+PadShmReader *padshm_open(const char *name);
+int padshm_slot_count(const PadShmReader *reader);
+// Returns 1 on success, 0 if the slot is out of range or the writer stalled mid-update
+int padshm_read(const PadShmReader *reader, int slot, PadShmSnapshot *out);
+void padshm_close(PadShmReader *reader);
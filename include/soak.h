@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+#include <input.h>
+#include <timing.h>
+
+/* Soak-test statistics. Every connected pad is sampled once a frame (RawInput
+pads from their first report, XInput pads on every successful poll) into a
+fixed-size block of running sums, so memory stays constant no matter how long
+the run is. Nothing here does I/O until soak_write_report. Axis
+values are the decoded (deadzoned) ones, the same numbers the panels show. */
+
+// Sources are per backend slot, RawInput first then XInput
+#define SOAK_MAX_SOURCES (MAX_HID_DEVICES + MAX_CONTROLLERS)
+#define SOAK_SOURCE_RAW(i)    (i)
+#define SOAK_SOURCE_XINPUT(i) (MAX_HID_DEVICES + (i))
+
+#define SOAK_BUTTONS 32
+#define SOAK_WINDOW_US   60000000ull   // drift is tracked on one-minute windows
+#define SOAK_GAP_US      50000ull      // samples further apart than this count as a gap
+#define SOAK_STUCK_US    60000000ull   // a button held this long is flagged as stuck
+
+extern int soakEnabled;
+
+void soak_enable(void);
+void soak_sample(int source, const GamepadState *g, uint64_t nowUs);
+void soak_connect(int source, uint16_t vendorID, uint16_t productID);
+void soak_disconnect(int source);
+int soak_write_report(const char *path);
@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Raw monotonic tick counter. On Windows this is the QPC value, elsewhere it is
+// CLOCK_MONOTONIC in nanoseconds. Cheap enough to call per report.
+static inline uint64_t timing_ticks(void) {
+#ifdef _WIN32
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return (uint64_t)t.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline uint64_t timing_ticks_per_sec(void) {
+#ifdef _WIN32
+    static uint64_t freq = 0;
+    if (!freq) {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        freq = (uint64_t)f.QuadPart;
+    }
+    return freq;
+#else
+    return 1000000000ull;
+#endif
+}
+
+// Split the conversion so large tick values don't overflow the multiply
+static inline uint64_t timing_ticks_to_us(uint64_t ticks) {
+    uint64_t freq = timing_ticks_per_sec();
+    return (ticks / freq) * 1000000ull + (ticks % freq) * 1000000ull / freq;
+}
+
+static inline uint64_t timing_now_us(void) {
+    return timing_ticks_to_us(timing_ticks());
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <stdint.h>
+
+/* Scoped stage tracing, exported as Chrome trace-event JSON (loads in Perfetto
+and chrome://tracing). Build with -DTRACE_ENABLED to turn it on; otherwise every
+macro below compiles to nothing. Each thread records into its own buffer, so
+recording an event never takes a lock. */
+
+// Events kept per thread. The buffer is a ring, so long runs keep the newest ones.
+#ifndef TRACE_BUFFER_EVENTS
+#define TRACE_BUFFER_EVENTS (1 << 18)
+#endif
+#define TRACE_MAX_THREADS 32
+
+#ifdef TRACE_ENABLED
+
+typedef struct {
+    const char *name;   // must be a string literal, we only keep the pointer
+    uint64_t start;
+} TraceScope;
+
+TraceScope trace_scope_begin(const char *name);
+void trace_scope_end(TraceScope *scope);
+void trace_thread_name(const char *name);
+int trace_export(const char *path);
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+// Records the enclosing block as one complete ("X") event when it goes out of scope
+#define TRACE_SCOPE(name) \
+    TraceScope TRACE_CONCAT(traceScope_, __LINE__) \
+    __attribute__((cleanup(trace_scope_end))) = trace_scope_begin(name)
+
+#define TRACE_THREAD_NAME(name) trace_thread_name(name)
+#define TRACE_EXPORT(path) trace_export(path)
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#define TRACE_EXPORT(path) (0)
+
+#endif
@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+
+/* Scheduling for XInput polling, kept free of Windows headers so it can be
+driven by a fake getState on any platform. Connected slots are read every
+update and only decoded when dwPacketNumber moves. Empty slots are expensive
+to query, so xpoll_probe checks them on an exponential backoff, on a thread of
+its own in XInput.c. The update only reads an empty slot once a probe has
+found a pad in it, so a miss never lands on a frame. */
+
+#define XPOLL_MAX_SLOTS 4
+#define XPOLL_BACKOFF_MIN_US 100000    // first re-probe of an empty slot after 100ms
+#define XPOLL_BACKOFF_MAX_US 2000000   // settle at one probe every 2s
+#define XPOLL_PROBE_INTERVAL_US 50000  // how often the probe thread looks for due slots
+
+// Portable mirror of XINPUT_STATE
+typedef struct {
+    uint32_t packetNumber;
+    uint16_t buttons;
+    uint8_t leftTrigger;
+    uint8_t rightTrigger;
+    int16_t thumbLX;
+    int16_t thumbLY;
+    int16_t thumbRX;
+    int16_t thumbRY;
+} XPollRawState;
+
+// Same contract as XInputGetState: 0 on success, anything else means no pad
+typedef uint32_t (*XPollGetStateFn)(uint32_t slot, XPollRawState *state);
+
+typedef enum {
+    XPOLL_SKIPPED,        // empty slot, no probe has found anything
+    XPOLL_EMPTY,          // a probe found a pad but it was gone again by the read
+    XPOLL_UNCHANGED,      // connected, same packet as last time
+    XPOLL_CHANGED,        // connected, new packet in *out
+    XPOLL_DISCONNECTED    // was connected, now gone
+} XPollResult;
+
+/* Each slot is handed between the two threads. While connected or found the
+update owns it, otherwise the probe does, so getState never runs on one slot
+from both threads at once. */
+typedef struct {
+    // Update side
+    int connected;
+    uint32_t lastPacket;
+
+    // Handoff
+    int found;              // a probe saw a pad, the next update reads it
+    int rearm;              // the update lost the pad, probe again from the short backoff
+
+    // Probe side
+    uint64_t nextProbeUs;
+    uint32_t backoffUs;
+} XPollSlot;
+
+typedef struct {
+    XPollGetStateFn getState;
+    XPollSlot slots[XPOLL_MAX_SLOTS];
+    uint64_t nowUs;
+
+    // Counters for benchmarking the schedule, probes is written by the probe side only
+    uint64_t calls;
+    uint64_t decodes;
+    uint64_t skips;
+    uint64_t probes;
+} XPoller;
+
+void xpoll_init(XPoller *p, XPollGetStateFn getState);
+void xpoll_begin(XPoller *p, uint64_t nowUs);
+XPollResult xpoll_slot(XPoller *p, int slot, XPollRawState *out);
+
+// Probe side: query the empty slots that are due, returns how many pads it found
+int xpoll_probe(XPoller *p, uint64_t nowUs);
@@ -1,12 +1,105 @@
+#include <stdio.h>
 #include <xinput_Backend.h>
+#include <trace.h>
+#include <timing.h>
+#include <xinputPoller.h>
+#include <soak.h>
 
 // User defined
 #define INPUT_DEADZONE 0.15f
 
 static GamepadState controllers[MAX_CONTROLLERS];
+static XPoller poller;
+
+/* XInputGetCapabilitiesEx is undocumented (ordinal 108 of xinput1_4.dll) but
+is the only way to get a pad's VID/PID, which we need to match it against its
+RawInput twin. Without it identities stay at 0 and matching falls back to the
+IG_ marker alone. */
+typedef struct {
+    XINPUT_CAPABILITIES Capabilities;
+    WORD VendorId;
+    WORD ProductId;
+    WORD ProductVersion;
+    WORD unk1;
+    DWORD unk2;
+} XINPUT_CAPABILITIES_EX;
+
+typedef DWORD (WINAPI *XInputGetCapabilitiesExFn)(DWORD unk, DWORD userIndex, DWORD flags, XINPUT_CAPABILITIES_EX *caps);
+
+static XInputGetCapabilitiesExFn getCapabilitiesEx = NULL;
+static DeviceIdentity identity[MAX_CONTROLLERS];
+static int identityValid[MAX_CONTROLLERS];
+
+// Empty slots are probed here, XInputGetState on an empty slot is slow enough to cost a frame
+static HANDLE probeThread = NULL;
+static HANDLE probeStop = NULL;
+static int probeInline = 0;     // no probe thread, xinput_update probes instead
+
+// Default shim, adapts the real XInputGetState to the poller's portable state
+static uint32_t getStateXInput(uint32_t slot, XPollRawState *out) {
+    XINPUT_STATE state;
+    ZeroMemory(&state, sizeof(state));
+
+    DWORD result = XInputGetState(slot, &state);
+    if (result != ERROR_SUCCESS)
+        return result;
+
+    out->packetNumber = state.dwPacketNumber;
+    out->buttons      = state.Gamepad.wButtons;
+    out->leftTrigger  = state.Gamepad.bLeftTrigger;
+    out->rightTrigger = state.Gamepad.bRightTrigger;
+    out->thumbLX      = state.Gamepad.sThumbLX;
+    out->thumbLY      = state.Gamepad.sThumbLY;
+    out->thumbRX      = state.Gamepad.sThumbRX;
+    out->thumbRY      = state.Gamepad.sThumbRY;
+    return ERROR_SUCCESS;
+}
+
+static DWORD WINAPI probeWorker(LPVOID param) {
+    (void)param;
+    TRACE_THREAD_NAME("xinput probe");
+
+    while (WaitForSingleObject(probeStop, XPOLL_PROBE_INTERVAL_US / 1000) == WAIT_TIMEOUT)
+        xpoll_probe(&poller, timing_now_us());
+    return 0;
+}
 
 void xinput_init() {
     memset(controllers, 0, sizeof(controllers));
+    memset(identityValid, 0, sizeof(identityValid));
+    xpoll_init(&poller, getStateXInput);
+
+    HMODULE lib = LoadLibrary("xinput1_4.dll");
+    if (lib)
+        getCapabilitiesEx = (XInputGetCapabilitiesExFn)(void (*)(void))GetProcAddress(lib, MAKEINTRESOURCEA(108));
+
+    // Once up front so pads already plugged in show on the first update
+    xpoll_probe(&poller, timing_now_us());
+
+    probeStop = CreateEvent(NULL, TRUE, FALSE, NULL);
+    probeThread = probeStop ? CreateThread(NULL, 0, probeWorker, NULL, 0, NULL) : NULL;
+    if (!probeThread) {
+        printf("XInput probe thread failed: %lu\n", GetLastError());
+        probeInline = 1;
+    }
+}
+
+void xinput_shutdown() {
+    if (probeThread) {
+        SetEvent(probeStop);
+        WaitForSingleObject(probeThread, INFINITE);
+        CloseHandle(probeThread);
+        probeThread = NULL;
+    }
+    if (probeStop) {
+        CloseHandle(probeStop);
+        probeStop = NULL;
+    }
+}
+
+// Swap the XInputGetState implementation, for replaying or simulating pads
+void xinput_set_get_state(XPollGetStateFn getState) {
+    __atomic_store_n(&poller.getState, getState ? getState : getStateXInput, __ATOMIC_RELAXED);
 }
 
 // Convert raw XInput value to [-1,1] for sticks or [0,1] for triggers,
@@ -62,26 +155,48 @@ static uint16_t mapButtons(WORD buttons) {
 }
 
 void xinput_update() {
-    for (DWORD i = 0; i < MAX_CONTROLLERS; i++) {
-        XINPUT_STATE state;
-        ZeroMemory(&state, sizeof(state));
-
-        if (XInputGetState(i, &state) == ERROR_SUCCESS) {
-            GamepadState *g = &controllers[i];
-            g->connected = 1;
-
-            // Axes
-            g->axes[INPUT_AXIS_LEFT_X]  = applyDeadzoneNormalized(state.Gamepad.sThumbLX, INPUT_DEADZONE, 0);
-            g->axes[INPUT_AXIS_LEFT_Y]  = applyDeadzoneNormalized(state.Gamepad.sThumbLY, INPUT_DEADZONE, 0); // invert Y
-            g->axes[INPUT_AXIS_RIGHT_X] = applyDeadzoneNormalized(state.Gamepad.sThumbRX, INPUT_DEADZONE, 0);
-            g->axes[INPUT_AXIS_RIGHT_Y] = applyDeadzoneNormalized(state.Gamepad.sThumbRY, INPUT_DEADZONE,0);
-            g->axes[INPUT_AXIS_LT]      = applyDeadzoneNormalized(state.Gamepad.bLeftTrigger, INPUT_DEADZONE, 1);
-            g->axes[INPUT_AXIS_RT]      = applyDeadzoneNormalized(state.Gamepad.bRightTrigger, INPUT_DEADZONE, 1);
-
-            // Buttons + DPAD
-            g->buttons = mapButtons(state.Gamepad.wButtons);
-        } else {
-            controllers[i].connected = 0;
+    TRACE_SCOPE("xinput_update");
+    xpoll_begin(&poller, timing_now_us());
+    if (probeInline)
+        xpoll_probe(&poller, poller.nowUs);
+
+    for (int i = 0; i < MAX_CONTROLLERS; i++) {
+        XPollRawState state;
+        GamepadState *g = &controllers[i];
+
+        switch (xpoll_slot(&poller, i, &state)) {
+            case XPOLL_CHANGED:
+                if (!g->connected) {
+                    DeviceIdentity id;
+                    g->connected = 1;
+                    if (soakEnabled && xinput_get_identity(i, &id))
+                        soak_connect(SOAK_SOURCE_XINPUT(i), id.vendorID, id.productID);
+                }
+
+                // Axes
+                g->axes[INPUT_AXIS_LEFT_X]  = applyDeadzoneNormalized(state.thumbLX, INPUT_DEADZONE, 0);
+                g->axes[INPUT_AXIS_LEFT_Y]  = applyDeadzoneNormalized(state.thumbLY, INPUT_DEADZONE, 0); // invert Y
+                g->axes[INPUT_AXIS_RIGHT_X] = applyDeadzoneNormalized(state.thumbRX, INPUT_DEADZONE, 0);
+                g->axes[INPUT_AXIS_RIGHT_Y] = applyDeadzoneNormalized(state.thumbRY, INPUT_DEADZONE, 0);
+                g->axes[INPUT_AXIS_LT]      = applyDeadzoneNormalized(state.leftTrigger, INPUT_DEADZONE, 1);
+                g->axes[INPUT_AXIS_RT]      = applyDeadzoneNormalized(state.rightTrigger, INPUT_DEADZONE, 1);
+
+                // Buttons + DPAD
+                g->buttons = mapButtons(state.buttons);
+                // fall through
+            case XPOLL_UNCHANGED:
+                // Every poll that read the pad is a sample, so an idle pad isn't a gap
+                if (soakEnabled)
+                    soak_sample(SOAK_SOURCE_XINPUT(i), g, poller.nowUs);
+                break;
+            case XPOLL_DISCONNECTED:
+                g->connected = 0;
+                identityValid[i] = 0;
+                soak_disconnect(SOAK_SOURCE_XINPUT(i));
+                break;
+            default:
+                // Empty slot, the probe thread is looking after it
+                break;
         }
     }
 }
@@ -91,4 +206,25 @@ const GamepadState *xinput_get_gamepad(int index) {
         return NULL;
     }
     return &controllers[index];
-}
\ No newline at end of file
+}
+
+// VID/PID of a connected slot, looked up once per connection
+int xinput_get_identity(int index, DeviceIdentity *out) {
+    if (index < 0 || index >= MAX_CONTROLLERS || !controllers[index].connected)
+        return 0;
+
+    if (!identityValid[index]) {
+        XINPUT_CAPABILITIES_EX caps;
+        memset(&identity[index], 0, sizeof(DeviceIdentity));
+        identity[index].xinputInterface = -1;
+
+        if (getCapabilitiesEx && getCapabilitiesEx(1, (DWORD)index, 0, &caps) == ERROR_SUCCESS) {
+            identity[index].vendorID = caps.VendorId;
+            identity[index].productID = caps.ProductId;
+        }
+        identityValid[index] = 1;
+    }
+
+    *out = identity[index];
+    return 1;
+}
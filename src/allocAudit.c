@@ -0,0 +1,59 @@
+#ifdef ALLOC_AUDIT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <allocAudit.h>
+
+// Provided by the linker for -Wl,--wrap=<symbol>
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static long allocCount = 0;
+static long freeCount = 0;
+static __thread int steady = 0;
+
+static void onAlloc(const char *fn, size_t size) {
+    __atomic_fetch_add(&allocCount, 1, __ATOMIC_RELAXED);
+    if (steady) {
+        // stdio may allocate while reporting, which must not land back here
+        steady = 0;
+        fprintf(stderr, "alloc audit: %s(%zu) on a steady-state thread\n", fn, size);
+        fflush(stderr);
+        abort();
+    }
+}
+
+void *__wrap_malloc(size_t size) {
+    onAlloc("malloc", size);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    onAlloc("calloc", count * size);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    onAlloc("realloc", size);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+    if (ptr)
+        __atomic_fetch_add(&freeCount, 1, __ATOMIC_RELAXED);
+    __real_free(ptr);
+}
+
+void alloc_audit_steady(void) {
+    steady = 1;
+}
+
+void alloc_audit_report(void) {
+    printf("alloc audit: %ld allocations, %ld frees\n",
+        __atomic_load_n(&allocCount, __ATOMIC_RELAXED),
+        __atomic_load_n(&freeCount, __ATOMIC_RELAXED));
+}
+
+#endif
@@ -0,0 +1,401 @@
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <controllerDb.h>
+
+// HID Generic Desktop usages, same values as hidProfiles.h without pulling in the HID headers
+static const uint16_t sdlAxisToHidUsage[] = {
+    0x30, // a0 -> X
+    0x31, // a1 -> Y
+    0x32, // a2 -> Z
+    0x33, // a3 -> Rx
+    0x34, // a4 -> Ry
+    0x35, // a5 -> Rz
+};
+
+static int tokenIs(const char *s, int length, const char *name) {
+    return (int)strlen(name) == length && !memcmp(s, name, length);
+}
+
+static int parseButtonName(const char *s, int length) {
+    if (tokenIs(s, length, "a")) return INPUT_BTN_A;
+    if (tokenIs(s, length, "b")) return INPUT_BTN_B;
+    if (tokenIs(s, length, "x")) return INPUT_BTN_X;
+    if (tokenIs(s, length, "y")) return INPUT_BTN_Y;
+    if (tokenIs(s, length, "back")) return INPUT_BTN_BACK;
+    if (tokenIs(s, length, "start")) return INPUT_BTN_START;
+    if (tokenIs(s, length, "leftshoulder")) return INPUT_BTN_LB;
+    if (tokenIs(s, length, "rightshoulder")) return INPUT_BTN_RB;
+    if (tokenIs(s, length, "leftstick")) return INPUT_BTN_LS;
+    if (tokenIs(s, length, "rightstick")) return INPUT_BTN_RS;
+    return MAP_UNUSED;
+}
+
+static int parseAxisName(const char *s, int length) {
+    if (tokenIs(s, length, "leftx")) return INPUT_AXIS_LEFT_X;
+    if (tokenIs(s, length, "lefty")) return INPUT_AXIS_LEFT_Y;
+    if (tokenIs(s, length, "rightx")) return INPUT_AXIS_RIGHT_X;
+    if (tokenIs(s, length, "righty")) return INPUT_AXIS_RIGHT_Y;
+    if (tokenIs(s, length, "lefttrigger")) return INPUT_AXIS_LT;
+    if (tokenIs(s, length, "righttrigger")) return INPUT_AXIS_RT;
+    return MAP_UNUSED;
+}
+
+// The hat values rawInput's hid_hat_to_dpad assumes, anything else isn't honoured
+static const char *hatDpadName(const char *s, int length) {
+    if (tokenIs(s, length, "dpup")) return "h0.1";
+    if (tokenIs(s, length, "dpright")) return "h0.2";
+    if (tokenIs(s, length, "dpdown")) return "h0.4";
+    if (tokenIs(s, length, "dpleft")) return "h0.8";
+    return NULL;
+}
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = (char)tolower((unsigned char)c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Parse n hex chars, -1 if any of them isn't hex
+static long parseHexN(const char *s, int n) {
+    long v = 0;
+    for (int i = 0; i < n; i++) {
+        int d = hexDigit(s[i]);
+        if (d < 0) return -1;
+        v = (v << 4) | d;
+    }
+    return v;
+}
+
+// Parse 4 hex chars in little-endian to uint16_t
+static uint16_t parseHex(const char *s) {
+    long lo = parseHexN(s, 2), hi = parseHexN(s + 2, 2);
+    if (lo < 0 || hi < 0) return 0;
+    return (uint16_t)((hi << 8) | lo);
+}
+
+void parse_vid_pid(const char *guid, uint16_t *vid, uint16_t *pid) {
+    if (!guid || strnlen(guid, 32) < 32) {
+        *vid = 0;
+        *pid = 0;
+        return;
+    }
+
+    *vid = parseHex(guid + 8);   // bytes 8-11
+    *pid = parseHex(guid + 16);  // bytes 16-19
+}
+
+// FNV-1a over the four key bytes
+static uint32_t hashKey(uint32_t key) {
+    uint32_t h = 0x811c9dc5u;
+    for (int i = 0; i < 4; i++) {
+        h ^= (key >> (i * 8)) & 0xFF;
+        h *= 0x01000193u;
+    }
+    return h;
+}
+
+static int isPlatformLine(const char *line) {
+    const char *p = strstr(line, ",platform:");
+    if (!p) return 0;
+    p += strlen(",platform:");
+    size_t n = strlen(CDB_PLATFORM);
+    return !strncmp(p, CDB_PLATFORM, n) && (p[n] == ',' || p[n] == '\0');
+}
+
+int cdb_load(ControllerDb *db, const char *path) {
+    memset(db, 0, sizeof(*db));
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return -1;
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(fp);
+        return -1;
+    }
+
+    db->text = malloc(size + 1);
+    if (!db->text || fread(db->text, 1, size, fp) != (size_t)size) {
+        fclose(fp);
+        cdb_free(db);
+        return -1;
+    }
+    fclose(fp);
+    db->text[size] = '\0';
+
+    // Upper bound on entries is the line count, buckets are the next power of two above twice that
+    int lines = 1;
+    for (long i = 0; i < size; i++)
+        lines += db->text[i] == '\n';
+
+    uint32_t buckets = 16;
+    while (buckets < (uint32_t)lines * 2)
+        buckets <<= 1;
+
+    db->entries = malloc(sizeof(CdbEntry) * lines);
+    db->buckets = malloc(sizeof(int) * buckets);
+    if (!db->entries || !db->buckets) {
+        cdb_free(db);
+        return -1;
+    }
+    db->bucketMask = buckets - 1;
+    memset(db->buckets, 0xFF, sizeof(int) * buckets);
+
+    // Chains keep file order, so the first line for a VID/PID comes first
+    int *tails = malloc(sizeof(int) * buckets);
+    if (!tails) {
+        cdb_free(db);
+        return -1;
+    }
+
+    char *line = db->text;
+    while (line && *line) {
+        char *end = strchr(line, '\n');
+        if (end) *end = '\0';
+        size_t len = strlen(line);
+        if (len && line[len - 1] == '\r')
+            line[len - 1] = '\0';
+
+        if (line[0] != '#' && line[0] != '\0' && strchr(line, ',')) {
+            uint16_t vid, pid;
+            parse_vid_pid(line, &vid, &pid);
+
+            int e = db->entryCount++;
+            CdbEntry *entry = &db->entries[e];
+            entry->key = ((uint32_t)vid << 16) | pid;
+            entry->platformMatch = isPlatformLine(line);
+            entry->line = line;
+            entry->next = -1;
+
+            uint32_t b = hashKey(entry->key) & db->bucketMask;
+            if (db->buckets[b] < 0)
+                db->buckets[b] = e;
+            else
+                db->entries[tails[b]].next = e;
+            tails[b] = e;
+        }
+
+        line = end ? end + 1 : NULL;
+    }
+
+    free(tails);
+    return 0;
+}
+
+void cdb_free(ControllerDb *db) {
+    free(db->text);
+    free(db->entries);
+    free(db->buckets);
+    memset(db, 0, sizeof(*db));
+}
+
+const char *cdb_find(const ControllerDb *db, uint16_t vendorID, uint16_t productID) {
+    if (!db->buckets)
+        return NULL;
+
+    uint32_t key = ((uint32_t)vendorID << 16) | productID;
+    const char *first = NULL;
+
+    for (int e = db->buckets[hashKey(key) & db->bucketMask]; e >= 0; e = db->entries[e].next) {
+        const CdbEntry *entry = &db->entries[e];
+        if (entry->key != key)
+            continue;
+        if (entry->platformMatch)
+            return entry->line;
+        if (!first)
+            first = entry->line;
+    }
+    return first;
+}
+
+static void addUnsupported(CdbMapping *out, const char *text, int length) {
+    if (out->unsupportedCount < CDB_MAX_UNSUPPORTED)
+        out->unsupported[out->unsupportedCount++] = (CdbToken){ text, length };
+}
+
+static void parseMappingToken(CdbMapping *out, const char *text, int length, int *hatSeen) {
+    const char *colon = memchr(text, ':', length);
+    if (!colon) {
+        addUnsupported(out, text, length);
+        return;
+    }
+
+    const char *logical = text;
+    int logicalLength = (int)(colon - text);
+    const char *hid = colon + 1;
+    int hidLength = length - logicalLength - 1;
+    CdbToken token = { text, length };
+
+    if (tokenIs(logical, logicalLength, "platform")) {
+        out->platform = (CdbToken){ hid, hidLength };
+        return;
+    }
+
+    // Plain a<n> or b<n>. Half axes (+a0, a0+) aren't handled by the decoder, an
+    // inverted axis (a3~) is mapped like a3 the way it always was, just not flipped
+    int index = -1;
+    int inverted = 0;
+    if (hidLength >= 2 && (hid[0] == 'a' || hid[0] == 'b')) {
+        int digitsEnd = hidLength;
+        if (hid[0] == 'a' && hidLength >= 3 && hid[hidLength - 1] == '~') {
+            inverted = 1;
+            digitsEnd--;
+        }
+
+        index = 0;
+        for (int i = 1; i < digitsEnd; i++) {
+            if (hid[i] < '0' || hid[i] > '9') {
+                index = -1;
+                break;
+            }
+            index = index * 10 + (hid[i] - '0');
+        }
+    }
+
+    // AXES
+    if (index >= 0 && hid[0] == 'a') {
+        int ax = parseAxisName(logical, logicalLength);
+        if (ax != MAP_UNUSED && index < (int)(sizeof(sdlAxisToHidUsage)/sizeof(sdlAxisToHidUsage[0])) &&
+            out->axisCount < CDB_MAX_AXES) {
+            out->axes[out->axisCount++] = (CdbAxis){ ax, index, sdlAxisToHidUsage[index], inverted, token };
+            return;
+        }
+    }
+
+    // BUTTONS
+    if (index >= 0 && hid[0] == 'b') {
+        int btn = parseButtonName(logical, logicalLength);
+        if (btn != MAP_UNUSED && out->buttonCount < CDB_MAX_BUTTONS) {
+            out->buttons[out->buttonCount++] = (CdbButton){ btn, index, token };
+            return;
+        }
+    }
+
+    // DPAD, decoded from the hat switch with a fixed mapping
+    const char *hat = hatDpadName(logical, logicalLength);
+    if (hat && tokenIs(hid, hidLength, hat)) {
+        (*hatSeen)++;
+        return;
+    }
+
+    addUnsupported(out, text, length);
+}
+
+int cdb_resolve(const ControllerDb *db, uint16_t vendorID, uint16_t productID, CdbMapping *out) {
+    memset(out, 0, sizeof(*out));
+
+    const char *line = cdb_find(db, vendorID, productID);
+    if (!line)
+        return 0;
+
+    // GUID, name, then the mapping tokens
+    const char *comma = strchr(line, ',');
+    out->guid = (CdbToken){ line, (int)(comma - line) };
+
+    const char *tok = comma + 1;
+    const char *end = strchr(tok, ',');
+    if (!end) end = tok + strlen(tok);
+    out->name = (CdbToken){ tok, (int)(end - tok) };
+
+    int hatSeen = 0;
+    tok = *end ? end + 1 : end;
+    while (*tok) {
+        end = strchr(tok, ',');
+        if (!end) end = tok + strlen(tok);
+        if (end > tok)
+            parseMappingToken(out, tok, (int)(end - tok), &hatSeen);
+        tok = *end ? end + 1 : end;
+    }
+
+    out->hatDpad = hatSeen == 4;
+    out->platformMatch = isPlatformLine(line);
+    return 1;
+}
+
+int cdb_parse_query(const char *text, uint16_t *vendorID, uint16_t *productID) {
+    while (*text == ' ' || *text == '\t')
+        text++;
+
+    // SDL GUID, VID and PID are little-endian at characters 8 and 16
+    int hexRun = 0;
+    while (hexDigit(text[hexRun]) >= 0)
+        hexRun++;
+    if (hexRun == 32) {
+        if (parseHexN(text + 8, 4) < 0 || parseHexN(text + 16, 4) < 0)
+            return 0;
+        parse_vid_pid(text, vendorID, productID);
+        return 1;
+    }
+
+    // VID:PID, also accepts a space or slash between them
+    if (hexRun == 4 && (text[4] == ':' || text[4] == ' ' || text[4] == '/')) {
+        long vid = parseHexN(text, 4);
+        long pid = parseHexN(text + 5, 4);
+        if (pid < 0 || hexDigit(text[9]) >= 0)
+            return 0;
+        *vendorID = (uint16_t)vid;
+        *productID = (uint16_t)pid;
+        return 1;
+    }
+    return 0;
+}
+
+static void writeTokens(FILE *out, const char *label, const CdbToken *tokens, int count, size_t stride) {
+    fprintf(out, "\t%s=", label);
+    for (int i = 0; i < count; i++) {
+        const CdbToken *t = (const CdbToken *)((const char *)tokens + i * stride);
+        fprintf(out, "%s%.*s", i ? "," : "", t->length, t->text);
+    }
+    if (count == 0)
+        fputc('-', out);
+}
+
+int cdb_resolve_batch(const ControllerDb *db, FILE *in, FILE *out) {
+    char line[512];
+    int resolved = 0;
+    CdbMapping map;
+
+    while (fgets(line, sizeof(line), in)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '#' || line[0] == '\0') continue;
+
+        uint16_t vid, pid;
+        if (!cdb_parse_query(line, &vid, &pid)) {
+            fprintf(out, "%s\tinvalid query\n", line);
+            continue;
+        }
+
+        resolved++;
+        if (!cdb_resolve(db, vid, pid, &map)) {
+            fprintf(out, "%s\t%04X:%04X\tnot in DB\n", line, vid, pid);
+            continue;
+        }
+
+        fprintf(out, "%s\t%04X:%04X\t%.*s\tplatform=%.*s%s", line, vid, pid,
+            map.name.length, map.name.text,
+            map.platform.length ? map.platform.length : 4, map.platform.length ? map.platform.text : "none",
+            map.platformMatch ? "" : " (no " CDB_PLATFORM " entry)");
+
+        writeTokens(out, "axes", &map.axes[0].token, map.axisCount, sizeof(CdbAxis));
+        writeTokens(out, "buttons", &map.buttons[0].token, map.buttonCount, sizeof(CdbButton));
+        fprintf(out, "\tdpad=%s", map.hatDpad ? "hat" : "-");
+
+        // Mapped, but the decoder reads them unflipped
+        int inverted = 0;
+        fputs("\tinverted=", out);
+        for (int i = 0; i < map.axisCount; i++) {
+            if (!map.axes[i].inverted) continue;
+            const CdbToken *t = &map.axes[i].token;
+            fprintf(out, "%s%.*s", inverted++ ? "," : "", (int)(strchr(t->text, ':') - t->text), t->text);
+        }
+        if (!inverted)
+            fputc('-', out);
+        writeTokens(out, "unsupported", map.unsupported, map.unsupportedCount, sizeof(CdbToken));
+        fputc('\n', out);
+    }
+    return resolved;
+}
@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <decodePool.h>
+#include <trace.h>
+#include <allocAudit.h>
+
+typedef struct {
+    int index;
+    HANDLE thread;
+    HANDLE wake;
+    LONG sleeping;
+    char name[16];
+} DecodeShard;
+
+static DecodeShard shards[DECODE_MAX_THREADS];
+static int shardCount = 0;
+static HidRecord *records = NULL;
+static int recordCount = 0;
+static volatile LONG stopping = 0;
+
+static inline DecodeShard *shardOf(HidRecord *dev) {
+    return &shards[(dev - records) % shardCount];
+}
+
+static void publish(HidRecord *dev) {
+    uint32_t seq = dev->publishSeq;
+    __atomic_store_n(&dev->publishSeq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    dev->published = dev->shadow;
+    __atomic_store_n(&dev->publishSeq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// Decode everything queued for one device, returns 1 if there was anything
+static int drain(HidRecord *dev) {
+    ReportQueue *q = &dev->queue;
+    unsigned head = q->head;
+    unsigned tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    if (head == tail)
+        return 0;
+
+    for (; head != tail; head++) {
+        unsigned i = head % REPORT_QUEUE_DEPTH;
+        parseReport(dev, q->data + i * q->slotBytes, q->size[i]);
+    }
+    __atomic_store_n(&q->head, head, __ATOMIC_RELEASE);
+
+    // One publish per batch, the message thread only wants the latest state
+    publish(dev);
+    return 1;
+}
+
+// Does this shard have anything to do? Must not touch layouts, it runs right before sleeping.
+static int hasWork(const DecodeShard *shard) {
+    for (int i = shard->index; i < recordCount; i += shardCount) {
+        HidRecord *dev = &records[i];
+        LONG status = __atomic_load_n(&dev->status, __ATOMIC_SEQ_CST);
+        if (status == DEV_RETIRING && !__atomic_load_n(&dev->decodeAck, __ATOMIC_ACQUIRE))
+            return 1;
+        if (status == DEV_READY &&
+            __atomic_load_n(&dev->queue.tail, __ATOMIC_SEQ_CST) != dev->queue.head)
+            return 1;
+    }
+    return 0;
+}
+
+static DWORD WINAPI decodeWorker(LPVOID param) {
+    DecodeShard *shard = param;
+    TRACE_THREAD_NAME(shard->name);
+
+    // Naming the thread allocated its trace buffer, decoding itself never allocates
+    ALLOC_AUDIT_STEADY();
+    int idlePasses = 0;
+
+    while (!stopping) {
+        int worked = 0;
+
+        for (int i = shard->index; i < recordCount; i += shardCount) {
+            HidRecord *dev = &records[i];
+            LONG status = __atomic_load_n(&dev->status, __ATOMIC_ACQUIRE);
+
+            if (status == DEV_READY) {
+                worked |= drain(dev);
+            } else if (status == DEV_RETIRING && !dev->decodeAck) {
+                // Drop what's queued and let the registration worker free the layout
+                dev->queue.head = __atomic_load_n(&dev->queue.tail, __ATOMIC_ACQUIRE);
+                __atomic_store_n(&dev->decodeAck, 1, __ATOMIC_RELEASE);
+            }
+        }
+
+        if (worked) {
+            idlePasses = 0;
+            continue;
+        }
+        if (++idlePasses < DECODE_SPIN_PASSES) {
+            YieldProcessor();
+            continue;
+        }
+
+        // Announce we're going to sleep, then look once more so a push can't slip past us
+        __atomic_store_n(&shard->sleeping, 1, __ATOMIC_SEQ_CST);
+        if (!hasWork(shard) && !stopping)
+            WaitForSingleObject(shard->wake, INFINITE);
+        __atomic_store_n(&shard->sleeping, 0, __ATOMIC_SEQ_CST);
+        idlePasses = 0;
+    }
+    return 0;
+}
+
+int decode_pool_start(int threads, HidRecord *recs, int count) {
+    if (threads <= 0)
+        return 0;
+    if (threads > DECODE_MAX_THREADS)
+        threads = DECODE_MAX_THREADS;
+
+    records = recs;
+    recordCount = count;
+    shardCount = threads;
+    stopping = 0;
+
+    for (int i = 0; i < threads; i++) {
+        DecodeShard *shard = &shards[i];
+        shard->index = i;
+        shard->sleeping = 0;
+        snprintf(shard->name, sizeof(shard->name), "decode %d", i);
+
+        shard->wake = CreateEvent(NULL, FALSE, FALSE, NULL);
+        shard->thread = shard->wake ? CreateThread(NULL, 0, decodeWorker, shard, 0, NULL) : NULL;
+        if (!shard->thread) {
+            printf("Decode worker %d failed: %lu\n", i, GetLastError());
+            shardCount = i;
+            decode_pool_stop();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void decode_pool_stop(void) {
+    if (shardCount == 0)
+        return;
+
+    stopping = 1;
+    for (int i = 0; i < shardCount; i++) {
+        SetEvent(shards[i].wake);
+        WaitForSingleObject(shards[i].thread, INFINITE);
+        CloseHandle(shards[i].thread);
+        CloseHandle(shards[i].wake);
+    }
+    shardCount = 0;
+}
+
+int decode_pool_active(void) {
+    return shardCount > 0;
+}
+
+int decode_pool_attach(HidRecord *dev, UINT reportBytes) {
+    ReportQueue *q = &dev->queue;
+    q->data = malloc((size_t)REPORT_QUEUE_DEPTH * reportBytes);
+    q->slotBytes = q->data ? reportBytes : 0;
+    return q->data ? 0 : -1;
+}
+
+void decode_pool_detach(HidRecord *dev) {
+    free(dev->queue.data);
+    dev->queue.data = NULL;
+    dev->queue.slotBytes = 0;
+}
+
+void decode_pool_wake(HidRecord *dev) {
+    DecodeShard *shard = shardOf(dev);
+    if (__atomic_exchange_n(&shard->sleeping, 0, __ATOMIC_SEQ_CST))
+        SetEvent(shard->wake);
+}
+
+int decode_pool_push(HidRecord *dev, const BYTE *report, UINT size) {
+    ReportQueue *q = &dev->queue;
+    unsigned tail = q->tail;
+
+    // Full queue or a report longer than the device said it sends: drop it rather than stall the message thread
+    if (size > q->slotBytes ||
+        tail - __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) >= REPORT_QUEUE_DEPTH)
+        return 0;
+
+    unsigned i = tail % REPORT_QUEUE_DEPTH;
+    memcpy(q->data + i * q->slotBytes, report, size);
+    q->size[i] = size;
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_SEQ_CST);
+
+    decode_pool_wake(dev);
+    return 1;
+}
+
+/* Copy the latest decoded state. connected is only set if something was
+decoded since the last read, matching the inline path where a frame without
+reports shows the pad as idle. */
+void decode_pool_read(HidRecord *dev, GamepadState *out, uint32_t *lastSeq) {
+    uint32_t before, after;
+    GamepadState copy;
+
+    do {
+        before = __atomic_load_n(&dev->publishSeq, __ATOMIC_ACQUIRE);
+        copy = dev->published;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&dev->publishSeq, __ATOMIC_RELAXED);
+    } while ((before & 1) || before != after);
+
+    int fresh = before != *lastSeq;
+    *lastSeq = before;
+    *out = copy;
+    out->connected = fresh && copy.connected;
+}
@@ -0,0 +1,122 @@
+#include <ds4Sensors.h>
+
+/* Offsets are relative to the start of the common input block, which begins
+right after the report ID on USB and 3 bytes in on Bluetooth. */
+#define DS4_OFF_TIMESTAMP 9
+#define DS4_OFF_GYRO      12
+#define DS4_OFF_ACCEL     18
+#define DS4_BLOCK_SIZE    24
+
+#define Q16_ONE     65536
+#define DEG_Q16(d)  ((int32_t)((d) * Q16_ONE))
+
+/* Nominal sensor ranges (uncalibrated). Gyro is ±2000 deg/s over 16 bits so
+16.384 LSB per deg/s, which makes one LSB exactly 4000 in Q16 deg/s. */
+#define DS4_GYRO_Q16_PER_LSB 4000
+
+// How hard the accelerometer pulls pitch/roll back each report (~1%)
+#define DS4_ACCEL_WEIGHT_Q16 655
+
+int ds4_is_device(uint16_t vendorID, uint16_t productID) {
+    return vendorID == DS4_VENDOR_ID &&
+        (productID == DS4_PRODUCT_ID_V1 || productID == DS4_PRODUCT_ID_V2);
+}
+
+void ds4_imu_reset(Ds4ImuFilter *f) {
+    f->pitch = 0;
+    f->roll = 0;
+    f->yaw = 0;
+    f->lastTimestamp = 0;
+    f->primed = 0;
+}
+
+static inline int16_t readS16(const uint8_t *p) {
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+// atan for 0 <= z <= 1 (Q16), returns Q16 degrees. Max error is under 0.1 degree.
+static int32_t atanUnitQ16(int64_t z) {
+    // 45z + z(1-z)(14.02 + 3.80z)
+    int64_t poly = 918815 + ((249037 * z) >> 16);
+    int64_t curve = (z * (Q16_ONE - z)) >> 16;
+    return (int32_t)(45 * z + ((curve * poly) >> 16));
+}
+
+static int32_t atan2Q16(int32_t y, int32_t x) {
+    int64_t ax = x < 0 ? -(int64_t)x : x;
+    int64_t ay = y < 0 ? -(int64_t)y : y;
+    if (ax == 0 && ay == 0) return 0;
+
+    int32_t a;
+    if (ay <= ax)
+        a = atanUnitQ16((ay << 16) / ax);
+    else
+        a = DEG_Q16(90) - atanUnitQ16((ax << 16) / ay);
+
+    if (x < 0) a = DEG_Q16(180) - a;
+    return y < 0 ? -a : a;
+}
+
+// Keep angles in [-180, 180)
+static inline int32_t wrapQ16(int32_t a) {
+    while (a >= DEG_Q16(180)) a -= DEG_Q16(360);
+    while (a < -DEG_Q16(180)) a += DEG_Q16(360);
+    return a;
+}
+
+static inline int32_t blendQ16(int32_t angle, int32_t target) {
+    int32_t diff = wrapQ16(target - angle);
+    return wrapQ16(angle + (int32_t)(((int64_t)diff * DS4_ACCEL_WEIGHT_Q16) >> 16));
+}
+
+int ds4_imu_decode(Ds4ImuFilter *f, const uint8_t *report, uint32_t size, GamepadSensors *out) {
+    uint32_t base;
+    if (size > 0 && report[0] == DS4_REPORT_USB)
+        base = 1;
+    else if (size > 0 && report[0] == DS4_REPORT_BT)
+        base = 3;
+    else
+        return 0;
+
+    if (size < base + DS4_BLOCK_SIZE)
+        return 0;
+
+    const uint8_t *block = report + base;
+    uint16_t timestamp = (uint16_t)(block[DS4_OFF_TIMESTAMP] | (block[DS4_OFF_TIMESTAMP + 1] << 8));
+
+    for (int i = 0; i < 3; i++) {
+        out->gyro[i]  = readS16(block + DS4_OFF_GYRO + i * 2);
+        out->accel[i] = readS16(block + DS4_OFF_ACCEL + i * 2);
+    }
+    out->present = 1;
+
+    // Gravity gives absolute pitch/roll. Axes are x right, y up, z towards the player.
+    int32_t accelPitch = atan2Q16(out->accel[2], out->accel[1]);
+    int32_t accelRoll  = atan2Q16(-out->accel[0], out->accel[1]);
+
+    if (!f->primed) {
+        f->pitch = accelPitch;
+        f->roll = accelRoll;
+        f->yaw = 0;
+        f->primed = 1;
+    } else {
+        // Timestamp ticks are 16/3 us and wrap at 16 bits
+        int64_t dtUs = (int64_t)(uint16_t)(timestamp - f->lastTimestamp) * 16 / 3;
+
+        // rate(Q16 deg/s) * dt(us) / 1e6, folded so it stays in 64 bits
+        int64_t scale = (int64_t)DS4_GYRO_Q16_PER_LSB * dtUs;
+        int32_t dPitch = (int32_t)(out->gyro[0] * scale / 1000000);
+        int32_t dYaw   = (int32_t)(out->gyro[1] * scale / 1000000);
+        int32_t dRoll  = (int32_t)(out->gyro[2] * scale / 1000000);
+
+        f->pitch = blendQ16(wrapQ16(f->pitch + dPitch), accelPitch);
+        f->roll  = blendQ16(wrapQ16(f->roll + dRoll), accelRoll);
+        f->yaw   = wrapQ16(f->yaw + dYaw);
+    }
+    f->lastTimestamp = timestamp;
+
+    out->pitch = f->pitch / (float)Q16_ONE;
+    out->roll  = f->roll / (float)Q16_ONE;
+    out->yaw   = f->yaw / (float)Q16_ONE;
+    return 1;
+}
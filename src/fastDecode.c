@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <string.h>
+#include <fastDecode.h>
+#include <hidProfiles.h>
+
+// DualShock 4 (USB report 0x01). L2/R2 analog come through as Rx/Ry.
+static const FastLayout ds4Layout = {
+    .reportID     = 0x01,
+    .reportLength = 64,
+    .axisOffset   = { 1, 2, 3, 8, 9, 4 },
+    .hatOffset    = 5,
+    .buttonBit    = 5 * 8 + 4,
+    .buttonCount  = 14,
+};
+
+// PlayStation Classic, no report ID. D-pad is reported on 2-bit X/Y which the DB maps as +a/-a tokens.
+static const FastLayout psClassicLayout = {
+    .reportID     = 0x00,
+    .reportLength = 3,
+    .axisOffset   = { FAST_NO_FIELD, FAST_NO_FIELD, FAST_NO_FIELD, FAST_NO_FIELD, FAST_NO_FIELD, FAST_NO_FIELD },
+    .hatOffset    = FAST_NO_FIELD,
+    .buttonBit    = 8,
+    .buttonCount  = 10,
+};
+
+// 8-bit axes normalized the same way parseReport does for a 0..255 logical range
+static float axisLut[256];
+static uint32_t hatLut[16];
+static int tablesReady = 0;
+
+static void buildTables(void) {
+    for (int v = 0; v < 256; v++)
+        axisLut[v] = hid_normalize_axis(v, 0, 255);
+
+    for (int h = 0; h < 16; h++)
+        hatLut[h] = hid_hat_to_dpad(h);
+
+    tablesReady = 1;
+}
+
+/* The layout pointer is a compile-time constant in every caller below, so the
+offsets fold into immediates and the fixed-size loops unroll. */
+static inline __attribute__((always_inline))
+void decodeWithLayout(const FastLayout *L, const FastDecoder *d, const uint8_t *r, GamepadState *g) {
+    float slot[FAST_AXIS_SLOTS];
+
+    g->connected = 1;
+    memset(g->axes, 0, sizeof(g->axes));
+
+#pragma GCC unroll 6
+    for (int i = 0; i < FAST_AXIS_SLOTS; i++)
+        slot[i] = L->axisOffset[i] != FAST_NO_FIELD ? axisLut[r[L->axisOffset[i]]] : 0.0f;
+
+    for (int i = 0; i < d->axisMapCount; i++)
+        g->axes[d->axisMap[i].mappedEnum] = slot[d->axisMap[i].slot];
+
+    // Gather the button bits into one word starting at HID button 1
+    const int shift = L->buttonBit % 8;
+    const int rawBytes = (shift + L->buttonCount + 7) / 8;
+    uint64_t raw = 0;
+#pragma GCC unroll 5
+    for (int i = 0; i < rawBytes; i++)
+        raw |= (uint64_t)r[L->buttonBit / 8 + i] << (8 * i);
+    raw = (raw >> shift) & ((1ull << L->buttonCount) - 1);
+
+    uint32_t buttons = 0;
+#pragma GCC unroll 4
+    for (int i = 0; i < (L->buttonCount + 7) / 8; i++)
+        buttons |= d->buttonLut[i][(raw >> (8 * i)) & 0xFF];
+
+    if (L->hatOffset != FAST_NO_FIELD && d->useHat)
+        buttons |= hatLut[r[L->hatOffset] & 0x0F];
+
+    g->buttons = buttons;
+}
+
+#define DEFINE_FAST_DECODER(fn, layout) \
+    static void fn(const FastDecoder *d, const uint8_t *r, GamepadState *g) { \
+        decodeWithLayout(&(layout), d, r, g); \
+    }
+
+DEFINE_FAST_DECODER(decodeDs4, ds4Layout)
+DEFINE_FAST_DECODER(decodePsClassic, psClassicLayout)
+
+/* The Mayflash F700 has no DB entry in this tree, so there is no known HID
+layout to specialize and it stays on the generic path. */
+static const FastDecoderEntry registry[] = {
+    { 0x054C, 0x05C4, "DualShock 4",        &ds4Layout,       decodeDs4 },
+    { 0x054C, 0x09CC, "DualShock 4 v2",     &ds4Layout,       decodeDs4 },
+    { 0x054C, 0x0CDA, "PlayStation Classic", &psClassicLayout, decodePsClassic },
+};
+
+static int valueCapMatches(const HIDP_VALUE_CAPS *vc, const FastLayout *L, USHORT bits, LONG min, LONG max) {
+    return vc->ReportID == L->reportID && vc->BitSize == bits &&
+        vc->LogicalMin == min && vc->LogicalMax == max;
+}
+
+int fast_bind(HidLayout *layout) {
+    FastDecoder *d = &layout->fast;
+    d->entry = NULL;
+
+    const FastDecoderEntry *entry = NULL;
+    for (size_t i = 0; i < sizeof(registry) / sizeof(registry[0]); i++) {
+        if (registry[i].vendorID == layout->vendorID && registry[i].productID == layout->productID) {
+            entry = &registry[i];
+            break;
+        }
+    }
+    if (!entry) return 0;
+
+    const FastLayout *L = entry->layout;
+    if (layout->caps.InputReportByteLength != L->reportLength)
+        return 0;
+
+    // Axes: every DB-resolved axis must be an 8-bit 0..255 field the layout knows about
+    d->axisMapCount = 0;
+    for (int i = 0; i < layout->axisCount; i++) {
+        const AxisMapping *map = &layout->axes[i];
+        if (map->capIndex < 0 || map->capIndex >= layout->valueCapCount)
+            continue;
+        if (map->mappedEnum < 0 || map->mappedEnum >= INPUT_AXIS_COUNT)
+            return 0;
+
+        int slot = map->usage - HID_USAGE_X;
+        if (slot < 0 || slot >= FAST_AXIS_SLOTS || L->axisOffset[slot] == FAST_NO_FIELD)
+            return 0;
+        if (!valueCapMatches(&layout->valueCaps[map->capIndex], L, 8, 0, 255))
+            return 0;
+        if (d->axisMapCount >= FAST_MAX_AXIS_MAPS)
+            return 0;
+
+        d->axisMap[d->axisMapCount].slot = (uint8_t)slot;
+        d->axisMap[d->axisMapCount].mappedEnum = (uint8_t)map->mappedEnum;
+        d->axisMapCount++;
+    }
+
+    // Buttons: one contiguous range starting at usage 1
+    int rangeOk = 0;
+    for (USHORT j = 0; j < layout->buttonCapCount; j++) {
+        const HIDP_BUTTON_CAPS *bc = &layout->buttonCaps[j];
+        if (bc->UsagePage != HID_USAGE_PAGE_BUTTON || !bc->IsRange)
+            continue;
+        rangeOk = bc->ReportID == L->reportID && bc->Range.UsageMin == 1 &&
+            bc->Range.UsageMax - bc->Range.UsageMin + 1 == L->buttonCount;
+        break;
+    }
+    if (!rangeOk || L->buttonCount > FAST_BUTTON_BYTES * 8)
+        return 0;
+
+    memset(d->buttonLut, 0, sizeof(d->buttonLut));
+    for (int b = 0; b < layout->buttonCount; b++) {
+        const ButtonMapping *m = &layout->buttons[b];
+        if (m->usage == 0 || m->usage > L->buttonCount)
+            continue;
+
+        int bit = m->usage - 1;
+        for (int v = 0; v < 256; v++) {
+            if (v & (1 << (bit % 8)))
+                d->buttonLut[bit / 8][v] |= 1u << m->mappedEnum;
+        }
+    }
+
+    // Hat: layout and device have to agree on whether there is one
+    d->useHat = layout->hatCapIndex >= 0;
+    if (d->useHat != (L->hatOffset != FAST_NO_FIELD))
+        return 0;
+    if (d->useHat && !valueCapMatches(&layout->valueCaps[layout->hatCapIndex], L, 4, 0, 7))
+        return 0;
+
+    if (!tablesReady)
+        buildTables();
+
+    d->entry = entry;
+    return 1;
+}
@@ -0,0 +1,83 @@
+#include <string.h>
+#include <RawInput_Backend.h>
+
+// Capability-driven decode through HidP, works for any device the DB has a mapping for
+void hid_decode_generic(const HidLayout *layout, const BYTE *report, UINT size, GamepadState *g) {
+    g->connected = 1;
+    memset(g->axes, 0, sizeof(g->axes));
+    g->buttons = 0;
+
+    // Loop through DB-mapped axes
+    for (int i = 0; i < layout->axisCount; i++) {
+        const AxisMapping *map = &layout->axes[i];
+
+        // Skip if we couldn't find capIndex
+        if (map->capIndex < 0 || map->capIndex >= layout->valueCapCount)
+            continue;
+
+        const HIDP_VALUE_CAPS *vc = &layout->valueCaps[map->capIndex];
+        LONG value;
+
+        if (HidP_GetUsageValue(
+                HidP_Input,
+                vc->UsagePage,
+                0,
+                vc->NotRange.Usage,
+                &value,
+                layout->preparsed,
+                (PCHAR)report,
+                size
+            ) != HIDP_STATUS_SUCCESS)
+            continue;
+
+        // Normalize to [-1, 1]
+        g->axes[map->mappedEnum] = hid_normalize_axis(value, vc->LogicalMin, vc->LogicalMax);
+    }
+
+    // Loop through DB-mapped Buttons
+    ULONG usageCount = 32;
+    USAGE usages[32];
+
+    if (HidP_GetUsages(
+            HidP_Input,
+            HID_USAGE_PAGE_BUTTON,
+            0,
+            usages,
+            &usageCount,
+            layout->preparsed,
+            (PCHAR)report,
+            size
+        ) == HIDP_STATUS_SUCCESS) {
+
+        for (ULONG i = 0; i < usageCount; i++) {
+            for (int b = 0; b < layout->buttonCount; b++) {
+                if (layout->buttons[b].usage == usages[i]) {
+                    g->buttons |= (1u << layout->buttons[b].mappedEnum);
+                }
+            }
+        }
+    }
+
+    // Loop through DB-mapped DPAD mapping
+    if (layout->hatCapIndex >= 0) {
+        const HIDP_VALUE_CAPS *vc = &layout->valueCaps[layout->hatCapIndex];
+        LONG hat;
+
+        if (HidP_GetUsageValue(
+                HidP_Input,
+                vc->UsagePage,
+                0,
+                vc->NotRange.Usage,
+                &hat,
+                layout->preparsed,
+                (PCHAR)report,
+                size
+            ) == HIDP_STATUS_SUCCESS) {
+
+            // Clear DPAD bits first
+            g->buttons &= ~(BTN_DPAD_UP | BTN_DPAD_DOWN |
+                BTN_DPAD_LEFT | BTN_DPAD_RIGHT);
+            g->buttons |= hid_hat_to_dpad(hat);
+        }
+    }
+}
@@ -0,0 +1,192 @@
+#include <stdlib.h>
+#include <string.h>
+#include <hidProfiles.h>
+#include <trace.h>
+#include <arena.h>
+
+/* Interned decode layouts. A rig with a row of identical pads fetches the
+preparsed data for each one (it's the only way to know they really are
+identical), but only the first builds caps and scans the DB. The rest just
+bump a reference count. */
+
+// One distinct model per device at most, so this can never run out before hidRecord does
+static HidLayout layouts[MAX_HID_DEVICES];
+
+/* Preparsed data is fetched here first so it can be hashed. Only a new model
+copies it out into its own arena, a duplicate pad allocates nothing. Only
+the registration worker calls into this file, so one scratch buffer is enough. */
+static BYTE *scratch = NULL;
+static UINT scratchSize = 0;
+
+// FNV-1a over the preparsed blob, which is derived from the report descriptor
+static uint64_t hashDescriptor(const BYTE *data, UINT size) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (UINT i = 0; i < size; i++) {
+        h ^= data[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+static HidLayout *findLayout(uint16_t vendorID, uint16_t productID, uint64_t hash, const BYTE *preparsed, UINT size) {
+    for (int i = 0; i < MAX_HID_DEVICES; i++) {
+        HidLayout *l = &layouts[i];
+        if (l->refCount > 0 && l->vendorID == vendorID && l->productID == productID &&
+            l->descriptorHash == hash && l->preparsedSize == size &&
+            memcmp(l->preparsed, preparsed, size) == 0)
+            return l;
+    }
+    return NULL;
+}
+
+// Fill caps and resolve the DB mapping against them. Runs once per distinct model.
+static void buildLayout(HidLayout *layout) {
+    TRACE_SCOPE("buildLayout");
+
+    // Capabilities (preparsed, caps and mapping buffers are already carved from the arena)
+    layout->buttonCapCount = layout->caps.NumberInputButtonCaps;
+    layout->valueCapCount  = layout->caps.NumberInputValueCaps;
+
+    HidP_GetButtonCaps(HidP_Input, layout->buttonCaps, &layout->buttonCapCount, layout->preparsed);
+    HidP_GetValueCaps(HidP_Input, layout->valueCaps, &layout->valueCapCount, layout->preparsed);
+
+    // Identify axes based on Generic Desktop UsagePage
+    layout->axisCount = 0;
+    for (USHORT i = 0; i < layout->valueCapCount; i++) {
+        HIDP_VALUE_CAPS *vc = &layout->valueCaps[i];
+        if (vc->UsagePage == HID_USAGE_PAGE_GENERIC_DESKTOP) {
+            layout->axisCapIndex[layout->axisCount++] = i;
+        }
+    }
+
+    // buildHIDMap fills layout->axes[i].mappedEnum and layout->axes[i].usage
+    buildHIDMap(layout);
+
+    // Map Axes
+    for (int i = 0; i < layout->axisCount; i++) {
+        AxisMapping *map = &layout->axes[i];
+        map->capIndex = -1;
+
+        for (USHORT j = 0; j < layout->valueCapCount; j++) {
+            HIDP_VALUE_CAPS *vc = &layout->valueCaps[j];
+            if (vc->UsagePage != HID_USAGE_PAGE_GENERIC_DESKTOP)
+                continue;
+
+            // Match DB usage to RawInput usage
+            if (vc->NotRange.Usage == map->usage) {
+                map->capIndex = j;
+                break;
+            }
+        }
+    }
+
+    // Map Buttons
+    for (int i = 0; i < layout->buttonCount; i++) {
+        ButtonMapping *m = &layout->buttons[i];
+        m->usage = 0;
+
+        for (USHORT j = 0; j < layout->buttonCapCount; j++) {
+            HIDP_BUTTON_CAPS *bc = &layout->buttonCaps[j];
+
+            if (bc->UsagePage != HID_USAGE_PAGE_BUTTON)
+                continue;
+
+            if (bc->IsRange) {
+                USHORT usage = bc->Range.UsageMin + m->buttonIndex;
+                if (usage <= bc->Range.UsageMax) {
+                    m->usage = usage;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Map DPAD
+    layout->hatCapIndex = -1;
+
+    for (USHORT i = 0; i < layout->valueCapCount; i++) {
+        HIDP_VALUE_CAPS *vc = &layout->valueCaps[i];
+
+        if (vc->UsagePage == HID_USAGE_PAGE_GENERIC_DESKTOP &&
+            vc->NotRange.Usage == HID_USAGE_HAT_SWITCH) {
+            layout->hatCapIndex = i;
+        }
+    }
+
+    // Known controllers skip the HidP calls entirely
+    fast_bind(layout);
+}
+
+const HidLayout *layout_acquire(HANDLE device, uint16_t vendorID, uint16_t productID) {
+    // Preparsed data
+    UINT size = 0;
+    GetRawInputDeviceInfo(device, RIDI_PREPARSEDDATA, NULL, &size);
+    if (size == 0)
+        return NULL;
+
+    if (size > scratchSize) {
+        free(scratch);
+        scratch = malloc(size);
+        scratchSize = scratch ? size : 0;
+        if (!scratch)
+            return NULL;
+    }
+    if (GetRawInputDeviceInfo(device, RIDI_PREPARSEDDATA, scratch, &size) == (UINT)-1)
+        return NULL;
+
+    uint64_t hash = hashDescriptor(scratch, size);
+
+    HidLayout *layout = findLayout(vendorID, productID, hash, scratch, size);
+    if (layout) {
+        layout->refCount++;
+        return layout;
+    }
+
+    for (int i = 0; i < MAX_HID_DEVICES; i++) {
+        if (layouts[i].refCount == 0) {
+            layout = &layouts[i];
+            break;
+        }
+    }
+    if (!layout)
+        return NULL;
+
+    memset(layout, 0, sizeof(HidLayout));
+    layout->vendorID = vendorID;
+    layout->productID = productID;
+    layout->preparsedSize = size;
+    layout->descriptorHash = hash;
+
+    // Caps counts come from the scratch copy so the whole arena can be sized in one go
+    HidP_GetCaps((PHIDP_PREPARSED_DATA)scratch, &layout->caps);
+    size_t buttonBytes = sizeof(HIDP_BUTTON_CAPS) * layout->caps.NumberInputButtonCaps;
+    size_t valueBytes  = sizeof(HIDP_VALUE_CAPS)  * layout->caps.NumberInputValueCaps;
+
+    if (arena_init(&layout->arena, arena_round(size) + arena_round(buttonBytes) + arena_round(valueBytes)) != 0)
+        return NULL;
+
+    layout->preparsed  = arena_alloc(&layout->arena, size);
+    layout->buttonCaps = arena_alloc(&layout->arena, buttonBytes);
+    layout->valueCaps  = arena_alloc(&layout->arena, valueBytes);
+    memcpy(layout->preparsed, scratch, size);
+
+    buildLayout(layout);
+
+    layout->refCount = 1;
+    return layout;
+}
+
+void layout_release(const HidLayout *shared) {
+    if (!shared) return;
+
+    // Callers only ever see const layouts, this is the one place that owns them
+    HidLayout *layout = (HidLayout *)shared;
+    if (--layout->refCount > 0)
+        return;
+
+    // Preparsed data and both caps arrays go in one free
+    arena_free(&layout->arena);
+    layout->preparsed = NULL;
+    layout->buttonCaps = NULL;
+    layout->valueCaps = NULL;
+}
@@ -1,43 +1,159 @@
+#include <string.h>
 #include <input.h>
 #include <XInput_Backend.h>
 #include <RawInput_Backend.h>
 
-typedef enum {
-    INPUT_BACKEND_RAW,
-    INPUT_BACKEND_XINPUT
-} InputBackend;
+/* Merged device table. Every physical pad gets exactly one slot and one
+backend. A slot keeps its pad for as long as it stays connected, so pads
+don't jump around the screen when others come and go. */
+typedef struct {
+    InputBackend backend;
+    int index;      // slot within that backend
+} PadSlot;
 
-static InputBackend activeBackend = INPUT_BACKEND_RAW;
+static PadSlot pads[MAX_PADS];
+
+// RawInput record that each XInput slot is paired with, -1 if none
+static int xinputTwin[MAX_CONTROLLERS];
 
 void input_init() {
+    memset(pads, 0, sizeof(pads));
+    for (int i = 0; i < MAX_CONTROLLERS; i++)
+        xinputTwin[i] = -1;
+
     xinput_init();
     rawInit();
 }
 
+// RawInput decode workers, 0 keeps decoding on the message thread. Call before input_init.
+void input_set_decode_threads(int threads) {
+    rawinput_set_decode_threads(threads);
+}
+
+// RawInput reports the decode workers couldn't take, always 0 when decoding inline
+unsigned input_dropped_reports() {
+    return rawinput_get_dropped();
+}
+
+void input_shutdown() {
+    xinput_shutdown();
+    rawShutdown();
+}
+
+static int sameDevice(const DeviceIdentity *x, const DeviceIdentity *raw) {
+    // XInput pads show up on RawInput as IG_ interfaces. Unknown VID/PID matches any of them.
+    if (raw->xinputInterface < 0)
+        return 0;
+    if (x->vendorID == 0 && x->productID == 0)
+        return 1;
+    return x->vendorID == raw->vendorID && x->productID == raw->productID;
+}
+
+/* Pair each XInput pad with its RawInput twin and stop RawInput decoding it.
+XInput wins because it gives the triggers separately and needs no DB mapping. */
+static void pairTwins(int xinputPresent[], DeviceIdentity xinputId[], int rawPresent[], DeviceIdentity rawId[]) {
+    int claimed[MAX_HID_DEVICES] = {0};
+
+    // Keep pairs that are still valid
+    for (int x = 0; x < MAX_CONTROLLERS; x++) {
+        int r = xinputTwin[x];
+        if (r < 0) continue;
+        if (!xinputPresent[x] || !rawPresent[r] || !sameDevice(&xinputId[x], &rawId[r]))
+            xinputTwin[x] = -1;
+        else
+            claimed[r] = 1;
+    }
+
+    // Find twins for newly connected XInput pads
+    for (int x = 0; x < MAX_CONTROLLERS; x++) {
+        if (!xinputPresent[x] || xinputTwin[x] >= 0) continue;
+        for (int r = 0; r < MAX_HID_DEVICES; r++) {
+            if (rawPresent[r] && !claimed[r] && sameDevice(&xinputId[x], &rawId[r])) {
+                xinputTwin[x] = r;
+                claimed[r] = 1;
+                break;
+            }
+        }
+    }
+
+    for (int r = 0; r < MAX_HID_DEVICES; r++) {
+        rawinput_set_suppressed(r, claimed[r]);
+        if (claimed[r])
+            rawPresent[r] = 0;
+    }
+}
+
+static int findPad(InputBackend backend, int index) {
+    for (int i = 0; i < MAX_PADS; i++) {
+        if (pads[i].backend == backend && pads[i].index == index)
+            return i;
+    }
+    return -1;
+}
+
+static void assignPad(InputBackend backend, int index) {
+    if (findPad(backend, index) >= 0)
+        return;
+    for (int i = 0; i < MAX_PADS; i++) {
+        if (pads[i].backend == INPUT_BACKEND_NONE) {
+            pads[i].backend = backend;
+            pads[i].index = index;
+            return;
+        }
+    }
+}
+
 void input_update() {
     rawUpdate();
     xinput_update();
 
-    int hasXInput = 0;
-    for (int i = 0; i < MAX_CONTROLLERS; i++) {
-        const GamepadState *g = xinput_get_gamepad(i);
-        if (g && g->connected) {
-            hasXInput = 1;
-            break;
-        }
+    int xinputPresent[MAX_CONTROLLERS];
+    DeviceIdentity xinputId[MAX_CONTROLLERS];
+    for (int i = 0; i < MAX_CONTROLLERS; i++)
+        xinputPresent[i] = xinput_get_identity(i, &xinputId[i]);
+
+    int rawPresent[MAX_HID_DEVICES];
+    DeviceIdentity rawId[MAX_HID_DEVICES];
+    for (int i = 0; i < MAX_HID_DEVICES; i++)
+        rawPresent[i] = rawinput_get_identity(i, &rawId[i]);
+
+    pairTwins(xinputPresent, xinputId, rawPresent, rawId);
+
+    // Free slots whose pad is gone or now belongs to the other backend
+    for (int i = 0; i < MAX_PADS; i++) {
+        if (pads[i].backend == INPUT_BACKEND_XINPUT && !xinputPresent[pads[i].index])
+            pads[i].backend = INPUT_BACKEND_NONE;
+        else if (pads[i].backend == INPUT_BACKEND_RAW && !rawPresent[pads[i].index])
+            pads[i].backend = INPUT_BACKEND_NONE;
     }
 
-    activeBackend = hasXInput ? INPUT_BACKEND_XINPUT : INPUT_BACKEND_RAW;
+    for (int i = 0; i < MAX_CONTROLLERS; i++) {
+        if (xinputPresent[i]) assignPad(INPUT_BACKEND_XINPUT, i);
+    }
+    for (int i = 0; i < MAX_HID_DEVICES; i++) {
+        if (rawPresent[i]) assignPad(INPUT_BACKEND_RAW, i);
+    }
 }
 
 
 const GamepadState *input_get_gamepad(int index) {
-    switch (activeBackend)
+    if (index < 0 || index >= MAX_PADS)
+        return NULL;
+
+    switch (pads[index].backend)
     {
         case INPUT_BACKEND_RAW:
-            return rawinput_get_gamepad(index);
+            return rawinput_get_gamepad(pads[index].index);
         case INPUT_BACKEND_XINPUT:
-            return xinput_get_gamepad(index);
+            return xinput_get_gamepad(pads[index].index);
+        case INPUT_BACKEND_NONE:
+            break;
     }
     return NULL;
-}
\ No newline at end of file
+}
+
+InputBackend input_get_backend(int index) {
+    if (index < 0 || index >= MAX_PADS)
+        return INPUT_BACKEND_NONE;
+    return pads[index].backend;
+}
@@ -1,7 +1,14 @@
 #include <windows.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
 #include <input.h>
+#include <trace.h>
+#include <padShm.h>
+#include <allocAudit.h>
+#include <soak.h>
+#include <controllerDb.h>
 
 /* This defines the space we allocate for the controller, also really useful
 for offseting the spacing between controllers in RenderController. padding can also allow
@@ -11,13 +18,48 @@ us to add a cosmetic flair such as filling the border with a character or someth
 
 #define CONTROLLER_STRIDE (CONTROLLER_PANEL_WIDTH + CONTROLLER_PANEL_PADDING)
 
+// Controller rows 0-20, the motion block adds a blank row and rows 22-26 when a pad on screen has sensors
+#define CONTROLLER_PANEL_HEIGHT 21
+#define MOTION_PANEL_HEIGHT 6
+
+// Bottom line of the console shows which pads are on screen
+#define STATUS_ROWS 1
+
+// Frames before the main loop counts as steady state for the allocation audit
+#define AUDIT_WARMUP_FRAMES 120
+
+// Cleared by the console control handler so the main loop can shut down cleanly
+static volatile LONG running = 1;
+// Set by Ctrl+Break in soak mode, the main loop writes a summary and carries on
+static volatile LONG soakDumpRequested = 0;
+// Signalled once main has written its trace/soak output, closing the window waits on it
+static HANDLE exitDone = NULL;
+
 typedef struct {
     int height;
     int width;
+    int windowHeight;   // rows of the console window, height stops at what capacity can hold
+    int capacity;   // cells allocated in buffer, sized for the largest possible window
     char *buffer;
+    char *front;    // what the console shows right now, flushBuffer only writes rows that differ
+    int redraw;     // front is stale (first frame, resize), write everything
     HANDLE console;
 } ConsoleScreen;
 
+/* Which pads are on screen. Panels fill the console left to right, top to
+bottom, and first is the index into pads of the panel in the top left
+corner. Only the slots that hold a pad are paged through, and only those
+perPage panels get formatted. */
+typedef struct {
+    int columns;
+    int rows;
+    int perPage;
+    int first;
+    int count;              // pads to page through
+    int pads[MAX_PADS];     // input slots that hold a pad, in slot order
+    int panelHeight;        // rows per panel, taller if any pad shows motion
+} PanelGrid;
+
 void toBuffer (ConsoleScreen *screen, int x, int y, const char *string) {
     if (y < 0 || y >= screen->height) return;
 
@@ -28,80 +70,314 @@ void toBuffer (ConsoleScreen *screen, int x, int y, const char *string) {
     }
 }
 
-void renderController(ConsoleScreen *screen, const GamepadState *state, int conIndex) {
+void renderController(ConsoleScreen *screen, const GamepadState *state, int conIndex, int xOffset, int yOffset) {
+    TRACE_SCOPE("renderController");
     char tempBuffer[32];
-    int xOffset = conIndex * CONTROLLER_STRIDE;
 
     if (!state || !state->connected) {
-        toBuffer(screen, xOffset, 0, "No Controller.");
+        toBuffer(screen, xOffset, yOffset, "No Controller.");
         return;
     }
 
-    sprintf(tempBuffer, "Controller %d", conIndex);
-    toBuffer(screen, xOffset, 0, tempBuffer);
-    toBuffer(screen, xOffset, 1, "============");
+    sprintf(tempBuffer, "Controller %d (%s)", conIndex,
+        input_get_backend(conIndex) == INPUT_BACKEND_XINPUT ? "XInput" : "RawInput");
+    toBuffer(screen, xOffset, yOffset + 0, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 1, "============");
 
     sprintf(tempBuffer, "D-UP: %-8s", (state->buttons & BTN_DPAD_UP) ? "Pressed" : "Released");
-    toBuffer(screen, xOffset, 3, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 3, tempBuffer);
 
     sprintf(tempBuffer, "D-DOWN: %-8s", (state->buttons & BTN_DPAD_DOWN) ? "Pressed" : "Released");
-    toBuffer(screen, xOffset, 4, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 4, tempBuffer);
 
     sprintf(tempBuffer, "D-LEFT: %-8s", (state->buttons & BTN_DPAD_LEFT) ? "Pressed" : "Released");
-    toBuffer(screen, xOffset, 5, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 5, tempBuffer);
 
     sprintf(tempBuffer, "D-RIGHT: %-8s", (state->buttons & BTN_DPAD_RIGHT) ? "Pressed" : "Released");
-    toBuffer(screen, xOffset, 6, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 6, tempBuffer);
 
     sprintf(tempBuffer, "LX: %+0.3f", state->axes[INPUT_AXIS_LEFT_X]);
-    toBuffer(screen, xOffset, 8, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 8, tempBuffer);
 
     sprintf(tempBuffer, "LY: %+0.3f", state->axes[INPUT_AXIS_LEFT_Y]);
-    toBuffer(screen, xOffset, 9, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 9, tempBuffer);
 
     sprintf(tempBuffer, "RX: %+0.3f", state->axes[INPUT_AXIS_RIGHT_X]);
-    toBuffer(screen, xOffset, 11, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 11, tempBuffer);
 
     sprintf(tempBuffer, "RY: %+0.3f", state->axes[INPUT_AXIS_RIGHT_Y]);
-    toBuffer(screen, xOffset, 12, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 12, tempBuffer);
 
     sprintf(tempBuffer, "LT/Z: %+0.3f", state->axes[INPUT_AXIS_LT]);
-    toBuffer(screen, xOffset, 14, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 14, tempBuffer);
 
     sprintf(tempBuffer, "RT/RZ: %+0.3f", state->axes[INPUT_AXIS_RT]);
-    toBuffer(screen, xOffset, 15, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 15, tempBuffer);
 
     sprintf(tempBuffer, "A: %-8s", (state->buttons & BTN_A) ? "Pressed" : "Released");
-    toBuffer(screen, xOffset, 17, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 17, tempBuffer);
 
     sprintf(tempBuffer, "B: %-8s", (state->buttons & BTN_B) ? "Pressed" : "Released");
-    toBuffer(screen, xOffset, 18, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 18, tempBuffer);
 
     sprintf(tempBuffer, "X: %-8s", (state->buttons & BTN_X) ? "Pressed" : "Released");
-    toBuffer(screen, xOffset, 19, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 19, tempBuffer);
 
     sprintf(tempBuffer, "Y: %-8s", (state->buttons & BTN_Y) ? "Pressed" : "Released");
-    toBuffer(screen, xOffset, 20, tempBuffer);
+    toBuffer(screen, xOffset, yOffset + 20, tempBuffer);
 }
 
+// IMU block, drawn under the controller panel for devices that report motion
+void renderSensors(ConsoleScreen *screen, const GamepadState *state, int xOffset, int yOffset) {
+    char tempBuffer[32];
+
+    if (!state || !state->connected || !state->sensors.present)
+        return;
+
+    const GamepadSensors *s = &state->sensors;
+    yOffset += CONTROLLER_PANEL_HEIGHT + 1;
+
+    toBuffer(screen, xOffset, yOffset + 0, "Motion");
+    toBuffer(screen, xOffset, yOffset + 1, "============");
+
+    sprintf(tempBuffer, "Gyro: %+6d %+6d %+6d", s->gyro[0], s->gyro[1], s->gyro[2]);
+    toBuffer(screen, xOffset, yOffset + 2, tempBuffer);
+
+    sprintf(tempBuffer, "Accel: %+6d %+6d %+6d", s->accel[0], s->accel[1], s->accel[2]);
+    toBuffer(screen, xOffset, yOffset + 3, tempBuffer);
+
+    sprintf(tempBuffer, "P/R/Y: %+6.1f %+6.1f %+6.1f", s->pitch, s->roll, s->yaw);
+    toBuffer(screen, xOffset, yOffset + 4, tempBuffer);
+}
+
+// Only rows that changed since the last frame go to the console
 void flushBuffer(ConsoleScreen *screen) {
+    TRACE_SCOPE("flushBuffer");
     DWORD written;
-    COORD origin = {0,0};
-
-    WriteConsoleOutputCharacterA(
-        screen->console,
-        screen->buffer,
-        screen->width * screen->height,
-        origin,
-        &written
-    );
+
+    for (int y = 0; y < screen->height; y++) {
+        const char *row = screen->buffer + y * screen->width;
+        char *shown = screen->front + y * screen->width;
+
+        if (!screen->redraw && memcmp(row, shown, screen->width) == 0)
+            continue;
+
+        COORD origin = { 0, (SHORT)y };
+        WriteConsoleOutputCharacterA(screen->console, row, screen->width, origin, &written);
+        memcpy(shown, row, screen->width);
+    }
+    screen->redraw = 0;
+}
+
+// Follow console resizes without reallocating, the buffer already covers the largest window
+void syncScreenSize(ConsoleScreen *screen) {
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    if (!GetConsoleScreenBufferInfo(screen->console, &csbi))
+        return;
+
+    int width = csbi.srWindow.Right - csbi.srWindow.Left + 1;
+    int height = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+    if (width == screen->width && height == screen->windowHeight)
+        return;
+
+    // The console buffer can't be smaller than its window, only what we draw gets clamped
+    COORD size = { (SHORT)width, (SHORT)height };
+    SetConsoleScreenBufferSize(screen->console, size);
+    screen->windowHeight = height;
+
+    if (width * height > screen->capacity)
+        height = screen->capacity / width;
+
+    screen->width = width;
+    screen->height = height;
+    screen->redraw = 1;
 }
 
 void clearRegion(ConsoleScreen *screen) {
     memset(screen->buffer, ' ', screen->width * screen->height);
 }
 
-int main () {
+// Keep first on a row boundary and never scroll past the last full page
+static void clampGrid(PanelGrid *grid) {
+    int last = 0;
+    if (grid->count > grid->perPage)
+        last = (grid->count - grid->perPage + grid->columns - 1) / grid->columns * grid->columns;
+
+    grid->first = grid->first / grid->columns * grid->columns;
+    if (grid->first > last)
+        grid->first = last;
+    if (grid->first < 0)
+        grid->first = 0;
+}
+
+/* Collect the slots that hold a pad and size panels for what they show. The
+motion block only takes rows when some pad has sensors, so the plain panel
+fits the default 30-row console with the status line below it. */
+static void collectPads(PanelGrid *grid) {
+    int motion = 0;
+
+    grid->count = 0;
+    for (int i = 0; i < MAX_PADS; i++) {
+        if (input_get_backend(i) == INPUT_BACKEND_NONE)
+            continue;
+        grid->pads[grid->count++] = i;
+
+        const GamepadState *pad = input_get_gamepad(i);
+        if (pad && pad->sensors.present)
+            motion = 1;
+    }
+    grid->panelHeight = CONTROLLER_PANEL_HEIGHT + (motion ? MOTION_PANEL_HEIGHT : 0);
+}
+
+// Fit as many whole panels as the console has room for, always at least one
+void layoutGrid(const ConsoleScreen *screen, PanelGrid *grid) {
+    int rowStride = grid->panelHeight + CONTROLLER_PANEL_PADDING;
+
+    grid->columns = (screen->width + CONTROLLER_PANEL_PADDING) / CONTROLLER_STRIDE;
+    grid->rows = (screen->height - STATUS_ROWS + CONTROLLER_PANEL_PADDING) / rowStride;
+    if (grid->columns < 1)
+        grid->columns = 1;
+    if (grid->rows < 1)
+        grid->rows = 1;
+
+    grid->perPage = grid->columns * grid->rows;
+    clampGrid(grid);
+}
+
+// Page Up/Down flip a screenful, arrows scroll one row of panels
+static void scrollGrid(PanelGrid *grid, WORD key) {
+    switch (key) {
+        case VK_NEXT:  grid->first += grid->perPage; break;
+        case VK_PRIOR: grid->first -= grid->perPage; break;
+        case VK_DOWN:
+        case VK_RIGHT: grid->first += grid->columns; break;
+        case VK_UP:
+        case VK_LEFT:  grid->first -= grid->columns; break;
+        case VK_HOME:  grid->first = 0; break;
+        case VK_END:   grid->first = grid->count; break;
+        default: return;
+    }
+    clampGrid(grid);
+}
+
+// Drain console input without blocking: keys page the grid, resizes relayout it
+static void pollConsoleInput(HANDLE input, ConsoleScreen *screen, PanelGrid *grid) {
+    DWORD pending = 0;
+    INPUT_RECORD events[16];
+
+    while (GetNumberOfConsoleInputEvents(input, &pending) && pending > 0) {
+        DWORD read = 0;
+        if (!ReadConsoleInput(input, events, 16, &read) || read == 0)
+            return;
+
+        for (DWORD i = 0; i < read; i++) {
+            if (events[i].EventType == KEY_EVENT && events[i].Event.KeyEvent.bKeyDown)
+                scrollGrid(grid, events[i].Event.KeyEvent.wVirtualKeyCode);
+            else if (events[i].EventType == WINDOW_BUFFER_SIZE_EVENT)
+                syncScreenSize(screen);
+        }
+    }
+}
+
+void renderGrid(ConsoleScreen *screen, const PanelGrid *grid) {
+    char tempBuffer[96];
+    int rowStride = grid->panelHeight + CONTROLLER_PANEL_PADDING;
+    int last = grid->first + grid->perPage;
+    if (last > grid->count)
+        last = grid->count;
+
+    for (int i = grid->first; i < last; i++) {
+        int cell = i - grid->first;
+        int xOffset = (cell % grid->columns) * CONTROLLER_STRIDE;
+        int yOffset = (cell / grid->columns) * rowStride;
+
+        int slot = grid->pads[i];
+        const GamepadState *pad = input_get_gamepad(slot);
+        renderController(screen, pad, slot, xOffset, yOffset);
+        renderSensors(screen, pad, xOffset, yOffset);
+    }
+
+    // A console too short for one panel still keeps its status line readable
+    memset(screen->buffer + (screen->height - 1) * screen->width, ' ', screen->width);
+
+    if (grid->count == 0)
+        snprintf(tempBuffer, sizeof(tempBuffer), "No controllers connected");
+    else
+        snprintf(tempBuffer, sizeof(tempBuffer), "Pads %d-%d of %d   PgUp/PgDn, arrows to scroll",
+            grid->first + 1, last, grid->count);
+
+    // Only ever non-zero with --decode-threads, a worker couldn't keep up
+    unsigned dropped = input_dropped_reports();
+    if (dropped) {
+        size_t len = strlen(tempBuffer);
+        snprintf(tempBuffer + len, sizeof(tempBuffer) - len, "   %u reports dropped", dropped);
+    }
+    toBuffer(screen, 0, screen->height - 1, tempBuffer);
+}
+
+static BOOL WINAPI onConsoleCtrl(DWORD type) {
+    switch (type) {
+        case CTRL_BREAK_EVENT:
+            if (soakEnabled) {
+                soakDumpRequested = 1;
+                return TRUE;
+            }
+            running = 0;
+            return TRUE;
+        case CTRL_C_EVENT:
+            running = 0;
+            return TRUE;
+        case CTRL_CLOSE_EVENT:
+            // Windows ends the process as soon as we return, so hold it until main has cleaned up
+            running = 0;
+            if (exitDone)
+                WaitForSingleObject(exitDone, INFINITE);
+            return TRUE;
+    }
+    return FALSE;
+}
+
+// Non-interactive: resolve a list of GUIDs or VID:PIDs against the DB and exit
+static int resolveInventory(const char *listPath) {
+    ControllerDb db;
+    if (cdb_load(&db, CDB_DEFAULT_PATH) != 0) {
+        fprintf(stderr, "Failed to load %s\n", CDB_DEFAULT_PATH);
+        return 1;
+    }
+
+    FILE *in = strcmp(listPath, "-") ? fopen(listPath, "r") : stdin;
+    if (!in) {
+        fprintf(stderr, "Failed to open %s\n", listPath);
+        cdb_free(&db);
+        return 1;
+    }
+
+    cdb_resolve_batch(&db, in, stdout);
+
+    if (in != stdin)
+        fclose(in);
+    cdb_free(&db);
+    return 0;
+}
+
+int main (int argc, char **argv) {
+    const char *tracePath = "cdebug_trace.json";
+    const char *publishName = NULL;
+    const char *soakPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--trace") && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (!strcmp(argv[i], "--publish"))
+            publishName = (i + 1 < argc && strncmp(argv[i + 1], "--", 2)) ? argv[++i] : PADSHM_DEFAULT_NAME;
+        else if (!strcmp(argv[i], "--soak"))
+            soakPath = (i + 1 < argc && strncmp(argv[i + 1], "--", 2)) ? argv[++i] : "cdebug_soak.txt";
+        else if (!strcmp(argv[i], "--decode-threads") && i + 1 < argc)
+            input_set_decode_threads(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--resolve"))
+            return resolveInventory((i + 1 < argc && strncmp(argv[i + 1], "--", 2)) ? argv[i + 1] : "-");
+    }
+
     // Initialize console stuctures
     HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
     CONSOLE_SCREEN_BUFFER_INFO csbi;
@@ -112,8 +388,25 @@ int main () {
     // Load ConsoleScreen struct values
     screen.width = csbi.srWindow.Right - csbi.srWindow.Left + 1;
     screen.height = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+    screen.windowHeight = screen.height;
     screen.console = hConsole;
-    screen.buffer = malloc(screen.width * screen.height);
+
+    // Allocate once for the biggest window the console can have, resizes reuse it
+    COORD largest = GetLargestConsoleWindowSize(hConsole);
+    screen.capacity = largest.X * largest.Y;
+    if (screen.capacity < screen.width * screen.height)
+        screen.capacity = screen.width * screen.height;
+    screen.buffer = malloc(screen.capacity * 2);
+    screen.front = screen.buffer + screen.capacity;
+    screen.redraw = 1;
+
+    // Window input brings resize events along with the keys, processed input keeps Ctrl+C working
+    HANDLE hInput = GetStdHandle(STD_INPUT_HANDLE);
+    DWORD inputMode = 0;
+    GetConsoleMode(hInput, &inputMode);
+    SetConsoleMode(hInput, inputMode | ENABLE_WINDOW_INPUT | ENABLE_PROCESSED_INPUT);
+
+    PanelGrid grid = { .columns = 1, .panelHeight = CONTROLLER_PANEL_HEIGHT };
 
     COORD size = {
         (SHORT)screen.width,
@@ -124,23 +417,59 @@ int main () {
     system("cls");
 
     input_init();
-    
-    while (1) {
+    exitDone = CreateEvent(NULL, TRUE, FALSE, NULL);
+    SetConsoleCtrlHandler(onConsoleCtrl, TRUE);
+
+    if (publishName && padshm_publish_open(publishName, MAX_PADS) != 0)
+        publishName = NULL;
+    if (soakPath)
+        soak_enable();
+    TRACE_THREAD_NAME("main");
+
+    int frame = 0;
+
+    while (running) {
+        if (++frame == AUDIT_WARMUP_FRAMES)
+            ALLOC_AUDIT_STEADY();
+
+        pollConsoleInput(hInput, &screen, &grid);
+        syncScreenSize(&screen);
         clearRegion(&screen);
         input_update();
 
-        for (int conIndex = 0; conIndex < MAX_CONTROLLERS; conIndex++) {
-            int xOffset = conIndex * CONTROLLER_STRIDE;
+        // Pads come and go with input_update, so the grid is laid out after it
+        collectPads(&grid);
+        layoutGrid(&screen, &grid);
 
-            if (xOffset + CONTROLLER_PANEL_WIDTH >= screen.width)
-                break;
-
-            const GamepadState *pad = input_get_gamepad(conIndex);
-            renderController(&screen, pad, conIndex);
+        if (publishName) {
+            for (int i = 0; i < MAX_PADS; i++)
+                padshm_publish(i, input_get_gamepad(i));
         }
+
+        renderGrid(&screen, &grid);
         flushBuffer(&screen);
-        Sleep(16);
 
-        const GamepadState *pad = input_get_gamepad(0);
+        if (soakDumpRequested) {
+            soakDumpRequested = 0;
+            soak_write_report(soakPath);
+        }
+        Sleep(16);
     }
+
+    // Decode workers stop first so soak and trace see their final numbers
+    input_shutdown();
+
+    if (soakPath && soak_write_report(soakPath) != 0)
+        printf("Failed to write soak summary to %s\n", soakPath);
+
+    if (TRACE_EXPORT(tracePath) != 0)
+        printf("Failed to write trace to %s\n", tracePath);
+
+    padshm_publish_close();
+    free(screen.buffer);
+    ALLOC_AUDIT_REPORT();
+
+    if (exitDone)
+        SetEvent(exitDone);
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <padShm.h>
+#include <timing.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define sleepMs(ms) Sleep(ms)
+#else
+#include <unistd.h>
+#define sleepMs(ms) usleep((ms) * 1000)
+#endif
+
+/* Minimal reader: prints every connected slot ten times a second. Works
+against the tool (`cdebug --publish`) or the Linux stand-in writer. */
+
+int main(int argc, char **argv) {
+    const char *name = argc > 1 ? argv[1] : PADSHM_DEFAULT_NAME;
+    int frames = argc > 2 ? atoi(argv[2]) : -1;     // -1 runs until killed
+
+    PadShmReader *reader = padshm_open(name);
+    if (!reader) {
+        fprintf(stderr, "No valid pad segment named %s\n", name);
+        return 1;
+    }
+
+    for (int frame = 0; frames < 0 || frame < frames; frame++) {
+        uint64_t now = timing_now_us();
+
+        for (int i = 0; i < padshm_slot_count(reader); i++) {
+            PadShmSnapshot snap;
+            if (!padshm_read(reader, i, &snap) || !snap.state.connected)
+                continue;
+
+            printf("pad %2d  seq %8llu  age %6lluus  buttons %08X  LX %+0.3f  LY %+0.3f\n", i,
+                (unsigned long long)snap.sequence,
+                (unsigned long long)(now > snap.timestampUs ? now - snap.timestampUs : 0),
+                (unsigned)snap.state.buttons,
+                snap.state.axes[INPUT_AXIS_LEFT_X], snap.state.axes[INPUT_AXIS_LEFT_Y]);
+        }
+        printf("\n");
+        fflush(stdout);
+        sleepMs(100);
+    }
+
+    padshm_close(reader);
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <padShm.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Give up after this many torn reads, only happens if the writer died mid-update
+#define PADSHM_READ_RETRIES 1000
+
+struct PadShmReader {
+    const PadShmHeader *header;
+    size_t size;
+    int slotCount;      // validated against size at open, the header copy could change under us
+#ifdef _WIN32
+    HANDLE mapping;
+#endif
+};
+
+PadShmReader *padshm_open(const char *name) {
+    PadShmReader *reader = calloc(1, sizeof(PadShmReader));
+    if (!reader) return NULL;
+
+#ifdef _WIN32
+    reader->mapping = OpenFileMapping(FILE_MAP_READ, FALSE, name);
+    if (!reader->mapping) {
+        free(reader);
+        return NULL;
+    }
+    // Size 0 maps the whole segment
+    reader->header = MapViewOfFile(reader->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!reader->header) {
+        CloseHandle(reader->mapping);
+        free(reader);
+        return NULL;
+    }
+
+    // The view covers whole pages, the region size is how much we may touch
+    MEMORY_BASIC_INFORMATION info;
+    if (!VirtualQuery(reader->header, &info, sizeof(info)) || info.RegionSize < sizeof(PadShmHeader)) {
+        padshm_close(reader);
+        return NULL;
+    }
+    reader->size = info.RegionSize;
+#else
+    char path[128];
+    snprintf(path, sizeof(path), "/%s", name);
+
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        free(reader);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(PadShmHeader)) {
+        close(fd);
+        free(reader);
+        return NULL;
+    }
+    reader->size = (size_t)st.st_size;
+    void *view = mmap(NULL, reader->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        free(reader);
+        return NULL;
+    }
+    reader->header = view;
+#endif
+
+    // Never trust the header's own idea of how big the segment is
+    const PadShmHeader *h = reader->header;
+    if (__atomic_load_n(&h->magic, __ATOMIC_ACQUIRE) != PADSHM_MAGIC || h->version != PADSHM_VERSION ||
+        h->slotSize != sizeof(PadShmSlot) ||
+        reader->size < sizeof(PadShmHeader) + (uint64_t)h->slotCount * h->slotSize) {
+        padshm_close(reader);
+        return NULL;
+    }
+    reader->slotCount = (int)h->slotCount;
+    return reader;
+}
+
+int padshm_slot_count(const PadShmReader *reader) {
+    return reader->slotCount;
+}
+
+int padshm_read(const PadShmReader *reader, int slot, PadShmSnapshot *out) {
+    if (slot < 0 || slot >= reader->slotCount)
+        return 0;
+
+    const PadShmSlot *s = &reader->header->slots[slot];
+
+    for (int attempt = 0; attempt < PADSHM_READ_RETRIES; attempt++) {
+        uint32_t before = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        if (before & 1)
+            continue;
+
+        out->sequence    = s->sequence;
+        out->timestampUs = s->timestampUs;
+        memcpy(&out->state, (const void *)&s->state, sizeof(GamepadState));
+
+        // Order the copy before re-checking seq
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) == before)
+            return 1;
+    }
+    return 0;
+}
+
+void padshm_close(PadShmReader *reader) {
+    if (!reader) return;
+#ifdef _WIN32
+    UnmapViewOfFile(reader->header);
+    CloseHandle(reader->mapping);
+#else
+    munmap((void *)reader->header, reader->size);
+#endif
+    free(reader);
+}
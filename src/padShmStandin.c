@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <math.h>
+#include <unistd.h>
+#include <padShm.h>
+
+/* Linux stand-in for `cdebug --publish`. Publishes made-up pads through the
+same writer the tool uses, so readers can be developed and tested without
+Windows or a controller. Axes circle slowly, A toggles every second. */
+
+#define STANDIN_RATE_HZ 1000
+
+static volatile sig_atomic_t running = 1;
+
+static void onSignal(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+int main(int argc, char **argv) {
+    const char *name = argc > 1 ? argv[1] : PADSHM_DEFAULT_NAME;
+    int pads = argc > 2 ? atoi(argv[2]) : MAX_PADS;
+    if (pads < 1 || pads > MAX_PADS)
+        pads = MAX_PADS;
+
+    if (padshm_publish_open(name, pads) != 0)
+        return 1;
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    printf("Publishing %d pads to /%s at %d Hz, Ctrl+C to stop\n", pads, name, STANDIN_RATE_HZ);
+
+    GamepadState g;
+    memset(&g, 0, sizeof(g));
+    for (unsigned tick = 0; running; tick++) {
+        for (int p = 0; p < pads; p++) {
+            float phase = tick * 0.002f + p * 0.5f;
+            g.connected = 1;
+            g.axes[INPUT_AXIS_LEFT_X] = cosf(phase);
+            g.axes[INPUT_AXIS_LEFT_Y] = sinf(phase);
+            g.axes[INPUT_AXIS_RT] = (float)((tick + p * 100) % 1000) / 1000.0f;
+            g.buttons = ((tick / STANDIN_RATE_HZ) & 1) ? BTN_A : 0;
+            padshm_publish(p, &g);
+        }
+        usleep(1000000 / STANDIN_RATE_HZ);
+    }
+
+    padshm_publish_close();
+    return 0;
+}
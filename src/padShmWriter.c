@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <string.h>
+#include <padShm.h>
+#include <timing.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static PadShmHeader *shm = NULL;
+static size_t shmSize = 0;
+#ifdef _WIN32
+static HANDLE shmMapping = NULL;
+#else
+static char shmPath[128];
+#endif
+
+int padshm_publish_open(const char *name, int slotCount) {
+    if (shm) return 0;
+
+    shmSize = sizeof(PadShmHeader) + sizeof(PadShmSlot) * (size_t)slotCount;
+
+#ifdef _WIN32
+    shmMapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)shmSize, name);
+    if (!shmMapping) {
+        printf("CreateFileMapping failed: %lu\n", GetLastError());
+        return -1;
+    }
+    shm = MapViewOfFile(shmMapping, FILE_MAP_ALL_ACCESS, 0, 0, shmSize);
+    if (!shm) {
+        printf("MapViewOfFile failed: %lu\n", GetLastError());
+        CloseHandle(shmMapping);
+        shmMapping = NULL;
+        return -1;
+    }
+#else
+    snprintf(shmPath, sizeof(shmPath), "/%s", name);
+    int fd = shm_open(shmPath, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        perror("shm_open");
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)shmSize) != 0) {
+        perror("ftruncate");
+        close(fd);
+        return -1;
+    }
+    void *view = mmap(NULL, shmSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+    shm = view;
+#endif
+
+    memset(shm, 0, shmSize);
+    shm->version   = PADSHM_VERSION;
+    shm->slotCount = (uint32_t)slotCount;
+    shm->slotSize  = sizeof(PadShmSlot);
+    // Magic goes last so a reader never accepts a half-initialized header
+    __atomic_store_n(&shm->magic, PADSHM_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void padshm_publish(int slot, const GamepadState *state) {
+    if (!shm || slot < 0 || slot >= (int)shm->slotCount)
+        return;
+
+    PadShmSlot *s = &shm->slots[slot];
+    uint32_t seq = s->seq;
+
+    __atomic_store_n(&s->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    s->sequence++;
+    s->timestampUs = timing_now_us();
+    if (state)
+        s->state = *state;
+    else
+        memset(&s->state, 0, sizeof(s->state));
+
+    __atomic_store_n(&s->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void padshm_publish_close(void) {
+    if (!shm) return;
+#ifdef _WIN32
+    UnmapViewOfFile(shm);
+    CloseHandle(shmMapping);
+    shmMapping = NULL;
+#else
+    munmap(shm, shmSize);
+    shm_unlink(shmPath);
+#endif
+    shm = NULL;
+}
@@ -1,234 +1,229 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <RawInput_Backend.h>
 #include <hidProfiles.h>
+#include <trace.h>
+#include <soak.h>
+#include <decodePool.h>
 
-static GamepadState gState[MAX_CONTROLLERS];
-static HidRecord hidRecord[MAX_CONTROLLERS];
-static int hidDevCount = 0;
+static GamepadState gState[MAX_HID_DEVICES];
+static HidRecord hidRecord[MAX_HID_DEVICES];
 static HWND g_hwnd;
+static int decodeThreads = 0;    // 0 decodes on the message thread
+static unsigned droppedReports = 0;    // refused by the decode pool, message thread only
+
+/* Registration jobs, handed from WndProc to the worker thread. Single producer
+(the message thread) and single consumer (the worker), so plain atomics on the
+indices are enough. Each slot has at most a register and a release job in
+flight, which bounds the ring. */
+typedef enum {
+    REG_JOB_REGISTER,
+    REG_JOB_RELEASE
+} RegJobType;
+
+typedef struct {
+    RegJobType type;
+    int slot;
+} RegJob;
+
+#define REG_QUEUE_SIZE (MAX_HID_DEVICES * 2)
+
+static RegJob regQueue[REG_QUEUE_SIZE];
+static unsigned regHead = 0;   // written by the worker
+static unsigned regTail = 0;   // written by WndProc
+static HANDLE regSignal;
+static HANDLE regThread;
+static volatile LONG regStopping = 0;
+
+#ifdef FASTPATH_VERIFY
+/* Differential check: run the generic decoder on the same report and log any
+difference. Goes to a file, anything on stdout/stderr is painted over by the
+next frame of the UI. */
+#define FASTPATH_LOG "fastpath.log"
+
+static FILE *verifyLog;
+static LONG verifyMismatches;
+
+static void verifyFastPath(HidRecord *dev, const BYTE *report, UINT size) {
+    GamepadState expect = *dev->state;
+    hid_decode_generic(dev->layout, report, size, &expect);
+
+    const GamepadState *got = dev->state;
+    if (got->buttons == expect.buttons &&
+        memcmp(got->axes, expect.axes, sizeof(got->axes)) == 0)
+        return;
 
-static inline float applyDeadzone(float v, float dz) {
-    if (fabsf(v) < dz)
-        return 0.0f;
+    __atomic_add_fetch(&verifyMismatches, 1, __ATOMIC_RELAXED);
+    if (!verifyLog)
+        return;
 
-    // Rescale so we still reach ±1
-    if (v > 0.0f)
-        return (v - dz) / (1.0f - dz);
-    else
-        return (v + dz) / (1.0f - dz);
+    // One line per report, stdio locks the stream so decode workers don't interleave
+    char bytes[3 * 64 + 1];
+    UINT shown = size < 64 ? size : 64;
+    for (UINT i = 0; i < shown; i++)
+        snprintf(bytes + i * 3, 4, "%02X ", report[i]);
+    bytes[shown * 3] = 0;
+
+    fprintf(verifyLog, "%04X:%04X (%s): buttons %08X vs %08X, report %s\n",
+        dev->vendorID, dev->productID, dev->layout->fast.entry->name,
+        (unsigned)got->buttons, (unsigned)expect.buttons, bytes);
+    fflush(verifyLog);
 }
+#endif
 
 void parseReport(HidRecord *dev, const BYTE *report, UINT size) {
+    TRACE_SCOPE("parseReport");
+    const HidLayout *layout = dev->layout;
     GamepadState *g = dev->state;
-    g->connected = 1;
-    memset(g->axes, 0, sizeof(g->axes));
-    g->buttons = 0;
-
-    // Loop through DB-mapped axes
-    for (int i = 0; i < dev->axisCount; i++) {
-        AxisMapping *map = &dev->axes[i];
 
-        // Skip if we couldn't find capIndex
-        if (map->capIndex < 0 || map->capIndex >= dev->valueCapCount)
-            continue;
-
-        HIDP_VALUE_CAPS *vc = &dev->valueCaps[map->capIndex];
-        LONG value;
-
-        if (HidP_GetUsageValue(
-                HidP_Input,
-                vc->UsagePage,
-                0,
-                vc->NotRange.Usage,
-                &value,
-                dev->preparsed,
-                (PCHAR)report,
-                size
-            ) != HIDP_STATUS_SUCCESS)
-            continue;
-
-        // Normalize to [-1, 1]
-        float norm = (float)(value - vc->LogicalMin) / (float)(vc->LogicalMax - vc->LogicalMin);
-        norm = norm * 2.0f - 1.0f;
-
-        g->axes[map->mappedEnum] = applyDeadzone(norm, DEADZONE);
-    }
-
-    // Loop through DB-mapped Buttons
-    ULONG usageCount = 32;
-    USAGE usages[32];
-
-    if (HidP_GetUsages(
-            HidP_Input,
-            HID_USAGE_PAGE_BUTTON,
-            0,
-            usages,
-            &usageCount,
-            dev->preparsed,
-            (PCHAR)report,
-            size
-        ) == HIDP_STATUS_SUCCESS) {
-
-        for (ULONG i = 0; i < usageCount; i++) {
-            for (int b = 0; b < dev->buttonCount; b++) {
-                if (dev->buttons[b].usage == usages[i]) {
-                    g->buttons |= (1u << dev->buttons[b].mappedEnum);
-                }
-            }
-        }
+    if (layout->fast.entry && fast_decode(&layout->fast, report, size, g)) {
+#ifdef FASTPATH_VERIFY
+        verifyFastPath(dev, report, size);
+#endif
+    } else {
+        hid_decode_generic(layout, report, size, g);
     }
 
-    // Loop through DB-mapped DPAD mapping
-    if (dev->hatCapIndex >= 0) {
-        HIDP_VALUE_CAPS *vc = &dev->valueCaps[dev->hatCapIndex];
-        LONG hat;
-
-        if (HidP_GetUsageValue(
-                HidP_Input,
-                vc->UsagePage,
-                0,
-                vc->NotRange.Usage,
-                &hat,
-                dev->preparsed,
-                (PCHAR)report,
-                size
-            ) == HIDP_STATUS_SUCCESS) {
-
-            // Clear DPAD bits first
-            g->buttons &= ~(BTN_DPAD_UP | BTN_DPAD_DOWN |
-                BTN_DPAD_LEFT | BTN_DPAD_RIGHT);
-
-            switch (hat) {
-                case 0: g->buttons |= BTN_DPAD_UP; break;
-                case 1: g->buttons |= BTN_DPAD_UP | BTN_DPAD_RIGHT; break;
-                case 2: g->buttons |= BTN_DPAD_RIGHT; break;
-                case 3: g->buttons |= BTN_DPAD_DOWN | BTN_DPAD_RIGHT; break;
-                case 4: g->buttons |= BTN_DPAD_DOWN; break;
-                case 5: g->buttons |= BTN_DPAD_DOWN | BTN_DPAD_LEFT; break;
-                case 6: g->buttons |= BTN_DPAD_LEFT; break;
-                case 7: g->buttons |= BTN_DPAD_UP | BTN_DPAD_LEFT; break;
-                default: break; // neutral
-            }
-        }
-    }
+    // Sensor data sits at fixed offsets, no need to go through HidP
+    if (dev->hasImu)
+        ds4_imu_decode(&dev->imu, report, size, &g->sensors);
 }
 
 
-HidRecord *devReg(HANDLE hDevice) {
-    // Return existing record if already registered
-    for (int i = 0; i < hidDevCount; i++) {
-        if (hidRecord[i].device == hDevice)
+static HidRecord *findRecord(HANDLE hDevice) {
+    for (int i = 0; i < MAX_HID_DEVICES; i++) {
+        LONG status = __atomic_load_n(&hidRecord[i].status, __ATOMIC_ACQUIRE);
+        if (status != DEV_FREE && status != DEV_RETIRING && hidRecord[i].device == hDevice)
             return &hidRecord[i];
     }
+    return NULL;
+}
 
-    if (hidDevCount >= MAX_CONTROLLERS)
-        return NULL;
+static void pushJob(RegJobType type, int slot) {
+    unsigned tail = regTail;
+    regQueue[tail % REG_QUEUE_SIZE] = (RegJob){ type, slot };
+    __atomic_store_n(&regTail, tail + 1, __ATOMIC_RELEASE);
+    ReleaseSemaphore(regSignal, 1, NULL);
+}
 
-    HidRecord *dev = &hidRecord[hidDevCount++];
-    memset(dev, 0, sizeof(HidRecord));
-    dev->device = hDevice;
+// Worker side of registration: everything slow (device queries, caps, DB scan) happens here
+static void devReg(HidRecord *dev) {
+    TRACE_SCOPE("devReg");
 
     // Get VID/PID
     RID_DEVICE_INFO info;
     UINT infoSize = sizeof(info);
     info.cbSize = sizeof(info);
-    if (GetRawInputDeviceInfo(hDevice, RIDI_DEVICEINFO, &info, &infoSize) > 0) {
+    if (GetRawInputDeviceInfo(dev->device, RIDI_DEVICEINFO, &info, &infoSize) > 0) {
         if (info.dwType == RIM_TYPEHID) {
             dev->vendorID = info.hid.dwVendorId;
             dev->productID = info.hid.dwProductId;
         }
     }
 
-    // Preparsed data
-    UINT size = 0;
-    GetRawInputDeviceInfo(hDevice, RIDI_PREPARSEDDATA, NULL, &size);
-    dev->preparsed = malloc(size);
-    GetRawInputDeviceInfo(hDevice, RIDI_PREPARSEDDATA, dev->preparsed, &size);
-
-    // Capabilities
-    HidP_GetCaps(dev->preparsed, &dev->caps);
-    dev->buttonCapCount = dev->caps.NumberInputButtonCaps;
-    dev->valueCapCount  = dev->caps.NumberInputValueCaps;
-
-    dev->buttonCaps = malloc(sizeof(HIDP_BUTTON_CAPS) * dev->buttonCapCount);
-    dev->valueCaps  = malloc(sizeof(HIDP_VALUE_CAPS)  * dev->valueCapCount);
-
-    HidP_GetButtonCaps(HidP_Input, dev->buttonCaps, &dev->buttonCapCount, dev->preparsed);
-    HidP_GetValueCaps(HidP_Input, dev->valueCaps, &dev->valueCapCount, dev->preparsed);
-
-    // Identify axes based on Generic Desktop UsagePage
-    dev->axisCount = 0;
-    for (USHORT i = 0; i < dev->valueCapCount; i++) {
-        HIDP_VALUE_CAPS *vc = &dev->valueCaps[i];
-        if (vc->UsagePage == HID_USAGE_PAGE_GENERIC_DESKTOP) {
-            dev->axisCapIndex[dev->axisCount++] = i;
-        }
+    // XInput-capable pads expose an HID interface tagged IG_xx in their path
+    char name[256];
+    UINT nameSize = sizeof(name);
+    dev->xinputInterface = -1;
+    if (GetRawInputDeviceInfo(dev->device, RIDI_DEVICENAME, name, &nameSize) != (UINT)-1) {
+        name[sizeof(name) - 1] = '\0';
+        const char *ig = strstr(name, "IG_");
+        unsigned iface;
+        if (ig && sscanf(ig + 3, "%2x", &iface) == 1)
+            dev->xinputInterface = (int)iface;
     }
 
-    // buildHIDMap fills dev->axes[i].mappedEnum and dev->axes[i].usage
-    buildHIDMap(dev);
+    // Identical pads share preparsed data, caps and the resolved mapping
+    dev->layout = layout_acquire(dev->device, dev->vendorID, dev->productID);
 
-    // Map Axes
-    for (int i = 0; i < dev->axisCount; i++) {
-        AxisMapping *map = &dev->axes[i];
-        map->capIndex = -1;
+    dev->hasImu = ds4_is_device(dev->vendorID, dev->productID);
+    ds4_imu_reset(&dev->imu);
 
-        for (USHORT j = 0; j < dev->valueCapCount; j++) {
-            HIDP_VALUE_CAPS *vc = &dev->valueCaps[j];
-            if (vc->UsagePage != HID_USAGE_PAGE_GENERIC_DESKTOP)
-                continue;
+    /* Soak stats for a raw slot are written by this thread while the slot isn't
+    READY (connect here, disconnect on release) and by rawUpdate only while it
+    is, so each source keeps a single writer. */
+    soak_connect(SOAK_SOURCE_RAW((int)(dev - hidRecord)), dev->vendorID, dev->productID);
 
-            // Match DB usage to RawInput usage
-            if (vc->NotRange.Usage == map->usage) {
-                map->capIndex = j;
-                break;
-            }
-        }
-    }
+    int ready = dev->layout != NULL;
+    if (ready && decodeThreads)
+        ready = decode_pool_attach(dev, dev->layout->caps.InputReportByteLength) == 0;
 
-    // Map Buttons
-    for (int i = 0; i < dev->buttonCount; i++) {
-        ButtonMapping *m = &dev->buttons[i];
-        m->usage = 0;
+    // Publish. If the device was unplugged meanwhile the release job queued behind us cleans up.
+    LONG expected = DEV_PENDING;
+    __atomic_compare_exchange_n(&dev->status, &expected, ready ? DEV_READY : DEV_FAILED,
+        0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+}
 
-        for (USHORT j = 0; j < dev->buttonCapCount; j++) {
-            HIDP_BUTTON_CAPS *bc = &dev->buttonCaps[j];
+static DWORD WINAPI regWorker(LPVOID param) {
+    (void)param;
+    TRACE_THREAD_NAME("devReg worker");
 
-            if (bc->UsagePage != HID_USAGE_PAGE_BUTTON)
-                continue;
+    while (WaitForSingleObject(regSignal, INFINITE) == WAIT_OBJECT_0 && !regStopping) {
+        unsigned head = regHead;
+        if (head == __atomic_load_n(&regTail, __ATOMIC_ACQUIRE))
+            continue;
 
-            if (bc->IsRange) {
-                USHORT usage = bc->Range.UsageMin + m->buttonIndex;
-                if (usage <= bc->Range.UsageMax) {
-                    m->usage = usage;
-                    break;
-                }
-            }
+        RegJob job = regQueue[head % REG_QUEUE_SIZE];
+        __atomic_store_n(&regHead, head + 1, __ATOMIC_RELEASE);
+
+        HidRecord *dev = &hidRecord[job.slot];
+        if (job.type == REG_JOB_REGISTER) {
+            devReg(dev);
+        } else {
+            // The decode worker may still be inside parseReport, wait for it to let go
+            while (decode_pool_active() && !__atomic_load_n(&dev->decodeAck, __ATOMIC_ACQUIRE))
+                Sleep(0);
+            soak_disconnect(SOAK_SOURCE_RAW(job.slot));
+            decode_pool_detach(dev);
+
+            // Layouts are only ever touched on this thread, so the store needs no lock
+            layout_release(dev->layout);
+            dev->layout = NULL;
+            __atomic_store_n(&dev->status, DEV_FREE, __ATOMIC_RELEASE);
         }
     }
+    return 0;
+}
+
+// Called on arrival or on the first report from an unknown device
+static void requestRegistration(HANDLE hDevice) {
+    if (findRecord(hDevice))
+        return;
 
-    // Map DPAD
-    dev->hatCapIndex = -1;
+    for (int i = 0; i < MAX_HID_DEVICES; i++) {
+        HidRecord *dev = &hidRecord[i];
+        if (__atomic_load_n(&dev->status, __ATOMIC_ACQUIRE) != DEV_FREE)
+            continue;
 
-    for (USHORT i = 0; i < dev->valueCapCount; i++) {
-        HIDP_VALUE_CAPS *vc = &dev->valueCaps[i];
+        memset(dev, 0, sizeof(HidRecord));
+        dev->device = hDevice;
+        dev->state = decodeThreads ? &dev->shadow : &gState[i];
+        memset(&gState[i].sensors, 0, sizeof(gState[i].sensors));
+        __atomic_store_n(&dev->status, DEV_PENDING, __ATOMIC_RELEASE);
 
-        if (vc->UsagePage == HID_USAGE_PAGE_GENERIC_DESKTOP &&
-            vc->NotRange.Usage == HID_USAGE_HAT_SWITCH) {
-            dev->hatCapIndex = i;
-        }
+        pushJob(REG_JOB_REGISTER, i);
+        return;
     }
+}
 
-    dev->state = NULL;
-    for (int i = 0; i < MAX_CONTROLLERS; i++) {
-        if (!gState[i].connected) {
-            dev->state = &gState[i];
-            break;
-        }
+static void requestRemoval(HANDLE hDevice) {
+    HidRecord *dev = findRecord(hDevice);
+    if (!dev)
+        return;
+
+    // Mark state disconnected and stop parsing, the worker frees the slot
+    int slot = (int)(dev - hidRecord);
+    gState[slot].connected = 0;
+    if (decodeThreads) {
+        // seq_cst pairs with the decode worker's check before it sleeps
+        __atomic_store_n(&dev->status, DEV_RETIRING, __ATOMIC_SEQ_CST);
+        decode_pool_wake(dev);
+    } else {
+        __atomic_store_n(&dev->status, DEV_RETIRING, __ATOMIC_RELEASE);
     }
-    return dev;
+    pushJob(REG_JOB_RELEASE, slot);
 }
 
 
@@ -237,26 +232,10 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         case WM_INPUT_DEVICE_CHANGE: {
             HANDLE hDevice = (HANDLE)lParam;
 
-            if (wParam == GIDC_REMOVAL) {
-                for (int i = 0; i < hidDevCount; i++) {
-                    if (hidRecord[i].device == hDevice) {
-
-                        // Mark state disconnected
-                        hidRecord[i].state->connected = 0;
-
-                        // Free resources
-                        free(hidRecord[i].preparsed);
-                        free(hidRecord[i].buttonCaps);
-                        free(hidRecord[i].valueCaps);
-
-                        // Compact array (swap with last)
-                        hidRecord[i] = hidRecord[hidDevCount - 1];
-                        hidDevCount--;
-
-                        break;
-                    }
-                }
-            }
+            if (wParam == GIDC_ARRIVAL)
+                requestRegistration(hDevice);
+            else if (wParam == GIDC_REMOVAL)
+                requestRemoval(hDevice);
             break;
         }
         case WM_INPUT: {
@@ -288,14 +267,21 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             RAWINPUT *raw = (RAWINPUT *)buffer;
 
             if (raw->header.dwType == RIM_TYPEHID) {
-                HidRecord *dev = devReg(raw->header.hDevice);
-                if (dev) {
-                    // Parse the report
-                    int devIndex = (int)(dev - hidRecord);
+                HidRecord *dev = findRecord(raw->header.hDevice);
+
+                // Reports are dropped until the worker has the mapping ready
+                if (!dev) {
+                    requestRegistration(raw->header.hDevice);
+                } else if (__atomic_load_n(&dev->status, __ATOMIC_ACQUIRE) == DEV_READY && !dev->suppressed) {
+                    // Parse the report, or hand it to the device's decode worker
                     for (DWORD i = 0; i < raw->data.hid.dwCount; i++) {
                         const BYTE *report = raw->data.hid.bRawData + (i * raw->data.hid.dwSizeHid);
                         
-                        parseReport(dev, report, raw->data.hid.dwSizeHid);
+                        if (decodeThreads) {
+                            if (!decode_pool_push(dev, report, raw->data.hid.dwSizeHid))
+                                droppedReports++;
+                        } else
+                            parseReport(dev, report, raw->data.hid.dwSizeHid);
                     }
                 }
             }
@@ -312,6 +298,24 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 
 void rawInit() {
     memset(gState, 0, sizeof(gState));
+    memset(hidRecord, 0, sizeof(hidRecord));
+
+#ifdef FASTPATH_VERIFY
+    verifyLog = fopen(FASTPATH_LOG, "w");
+#endif
+
+    regStopping = 0;
+    regSignal = CreateSemaphore(NULL, 0, REG_QUEUE_SIZE + 1, NULL);
+    regThread = regSignal ? CreateThread(NULL, 0, regWorker, NULL, 0, NULL) : NULL;
+    if (!regThread) {
+        printf("Registration worker failed: %lu\n", GetLastError());
+        return;
+    }
+
+    // Decode workers have to be up before the first record is handed out
+    if (decodeThreads && decode_pool_start(decodeThreads, hidRecord, MAX_HID_DEVICES) != 0)
+        decodeThreads = 0;
+
     HINSTANCE hInstance = GetModuleHandle(NULL);
     WNDCLASS wc = {0};
     wc.lpfnWndProc = WndProc;
@@ -334,21 +338,21 @@ void rawInit() {
     rid[0] = (RAWINPUTDEVICE){
         .usUsagePage = 0x01,
         .usUsage     = 0x04,   // Joystick
-        .dwFlags     = RIDEV_INPUTSINK,
+        .dwFlags     = RIDEV_INPUTSINK | RIDEV_DEVNOTIFY,
         .hwndTarget  = g_hwnd
     };
 
     rid[1] = (RAWINPUTDEVICE){
         .usUsagePage = 0x01,
         .usUsage     = 0x05,   // Gamepad
-        .dwFlags     = RIDEV_INPUTSINK,
+        .dwFlags     = RIDEV_INPUTSINK | RIDEV_DEVNOTIFY,
         .hwndTarget  = g_hwnd
     };
 
     rid[2] = (RAWINPUTDEVICE){
         .usUsagePage = 0x01,
         .usUsage     = 0x08,   // Multi-axis
-        .dwFlags     = RIDEV_INPUTSINK,
+        .dwFlags     = RIDEV_INPUTSINK | RIDEV_DEVNOTIFY,
         .hwndTarget  = g_hwnd
     };
 
@@ -358,8 +362,27 @@ void rawInit() {
     }
 }
 
+/* Soak samples every live pad once a frame, the same as XInput polling. Lots
+of HID pads only send a report when something changes, so sampling on arrival
+would count every stick left alone as a gap. A slot starts at its first report
+so the blank state before it isn't counted. */
+static void sampleSoak(void) {
+    uint64_t nowUs = timing_now_us();
+    for (int i = 0; i < MAX_HID_DEVICES; i++) {
+        HidRecord *dev = &hidRecord[i];
+        if (__atomic_load_n(&dev->status, __ATOMIC_ACQUIRE) != DEV_READY || dev->suppressed)
+            continue;
+
+        if (gState[i].connected)
+            dev->soakStarted = 1;
+        if (dev->soakStarted)
+            soak_sample(SOAK_SOURCE_RAW(i), &gState[i], nowUs);
+    }
+}
+
 void rawUpdate() {
-    for (int i = 0; i < MAX_CONTROLLERS; i++) {
+    TRACE_SCOPE("rawUpdate");
+    for (int i = 0; i < MAX_HID_DEVICES; i++) {
         gState[i].connected = 0;
     }
     MSG msg;
@@ -367,10 +390,89 @@ void rawUpdate() {
         TranslateMessage(&msg);
         DispatchMessage(&msg);
     }
+
+    // Pick up whatever the decode workers published since last frame
+    if (decodeThreads) {
+        for (int i = 0; i < MAX_HID_DEVICES; i++) {
+            HidRecord *dev = &hidRecord[i];
+            if (__atomic_load_n(&dev->status, __ATOMIC_ACQUIRE) != DEV_READY || dev->suppressed)
+                continue;
+            decode_pool_read(dev, &gState[i], &dev->readSeq);
+        }
+    }
+
+    if (soakEnabled)
+        sampleSoak();
+}
+
+void rawinput_set_decode_threads(int threads) {
+    decodeThreads = threads > 0 ? threads : 0;
+}
+
+void rawShutdown() {
+    /* Registration goes first: a release job may be waiting on a decode worker's
+    ack, which needs the pool still running. Jobs still queued are dropped, the
+    process is on its way out. */
+    if (regThread) {
+        regStopping = 1;
+        ReleaseSemaphore(regSignal, 1, NULL);
+        WaitForSingleObject(regThread, INFINITE);
+        CloseHandle(regThread);
+        regThread = NULL;
+    }
+    if (regSignal) {
+        CloseHandle(regSignal);
+        regSignal = NULL;
+    }
+
+    decode_pool_stop();
+    decodeThreads = 0;
+
+    if (droppedReports)
+        printf("Decode pool dropped %u reports\n", droppedReports);
+
+#ifdef FASTPATH_VERIFY
+    // The UI is gone by now, so the summary stays on screen
+    if (verifyLog) {
+        fclose(verifyLog);
+        verifyLog = NULL;
+    }
+    if (verifyMismatches)
+        printf("Fast path: %ld mismatching reports, see " FASTPATH_LOG "\n", (long)verifyMismatches);
+#endif
 }
 
 const GamepadState *rawinput_get_gamepad(int index) {
-    if (index < 0 || index >= MAX_CONTROLLERS)
+    if (index < 0 || index >= MAX_HID_DEVICES)
         return NULL;
     return &gState[index];
-}
\ No newline at end of file
+}
+
+// Identity of a registered device, 0 if the slot has nothing ready in it
+int rawinput_get_identity(int index, DeviceIdentity *out) {
+    if (index < 0 || index >= MAX_HID_DEVICES)
+        return 0;
+
+    const HidRecord *dev = &hidRecord[index];
+    if (__atomic_load_n(&dev->status, __ATOMIC_ACQUIRE) != DEV_READY)
+        return 0;
+
+    out->vendorID = dev->vendorID;
+    out->productID = dev->productID;
+    out->xinputInterface = dev->xinputInterface;
+    return 1;
+}
+
+// Reports the decode pool had to drop so far, shown on the status row
+unsigned rawinput_get_dropped(void) {
+    return droppedReports;
+}
+
+void rawinput_set_suppressed(int index, int suppressed) {
+    if (index < 0 || index >= MAX_HID_DEVICES)
+        return;
+
+    hidRecord[index].suppressed = suppressed;
+    if (suppressed)
+        gState[index].connected = 0;
+}
@@ -0,0 +1,38 @@
+#include <stdio.h>
+#include <string.h>
+#include <controllerDb.h>
+
+/* Standalone batch resolver, the same lookup as `cdebug --resolve` without
+any Windows dependency. Reads one SDL GUID or VID:PID per line from a file
+or stdin and prints what mapping the tool would use for each. */
+int main(int argc, char **argv) {
+    const char *dbPath = CDB_DEFAULT_PATH;
+    const char *listPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--db") && i + 1 < argc)
+            dbPath = argv[++i];
+        else
+            listPath = argv[i];
+    }
+
+    ControllerDb db;
+    if (cdb_load(&db, dbPath) != 0) {
+        fprintf(stderr, "Failed to load %s\n", dbPath);
+        return 1;
+    }
+
+    FILE *in = stdin;
+    if (listPath && strcmp(listPath, "-") && !(in = fopen(listPath, "r"))) {
+        fprintf(stderr, "Failed to open %s\n", listPath);
+        cdb_free(&db);
+        return 1;
+    }
+
+    cdb_resolve_batch(&db, in, stdout);
+
+    if (in != stdin)
+        fclose(in);
+    cdb_free(&db);
+    return 0;
+}
@@ -0,0 +1,289 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <soak.h>
+
+typedef struct {
+    uint16_t vendorID;
+    uint16_t productID;
+    uint32_t replaced;      // other devices that held the slot earlier in the run
+    int resumed;            // first sample after a reconnect, the outage is already a disconnect
+
+    uint64_t samples;
+    uint64_t firstUs;
+    uint64_t lastUs;
+    uint64_t maxGapUs;
+    uint64_t gaps;
+    uint32_t disconnects;
+
+    /* Sums are taken around the first sample so the variance doesn't lose
+    precision over hours of data. Kept as plain per-axis arrays so each
+    update is a straight loop the compiler can vectorize. */
+    double shift[INPUT_AXIS_COUNT];
+    double sum[INPUT_AXIS_COUNT];
+    double sumSq[INPUT_AXIS_COUNT];
+    float min[INPUT_AXIS_COUNT];
+    float max[INPUT_AXIS_COUNT];
+
+    // Drift: mean of each window compared against the first full window
+    uint64_t windowStartUs;
+    uint64_t windowSamples;
+    double windowSum[INPUT_AXIS_COUNT];
+    int haveBaseline;
+    double baseline[INPUT_AXIS_COUNT];
+    double lastWindow[INPUT_AXIS_COUNT];
+    double maxDrift[INPUT_AXIS_COUNT];
+
+    // Buttons
+    uint32_t lastButtons;
+    uint64_t pressStartUs[SOAK_BUTTONS];
+    uint64_t longestHoldUs[SOAK_BUTTONS];
+    uint32_t presses[SOAK_BUTTONS];
+} SoakStats;
+
+/* Each source has one writer at a time (for a raw slot the registration worker
+while it's being set up or released and the message thread while it's live,
+the main loop for XInput), but the report can be written while the
+registration worker is still touching a raw slot. A per-source seqlock, the
+same scheme decodePool uses, lets soak_write_report take a consistent copy
+without the writers ever waiting. */
+int soakEnabled = 0;
+static SoakStats stats[SOAK_MAX_SOURCES];
+static uint32_t statsSeq[SOAK_MAX_SOURCES];
+static uint64_t soakStartUs;
+
+static const char *axisNames[INPUT_AXIS_COUNT] = { "LX", "LY", "RX", "RY", "LT", "RT" };
+static const char *buttonNames[SOAK_BUTTONS] = {
+    "A", "B", "X", "Y", "BACK", "START", "LB", "RB", "LS", "RS",
+    "D-UP", "D-DOWN", "D-LEFT", "D-RIGHT"
+};
+
+static inline void beginWrite(int source) {
+    uint32_t seq = statsSeq[source];
+    __atomic_store_n(&statsSeq[source], seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void endWrite(int source) {
+    __atomic_store_n(&statsSeq[source], statsSeq[source] + 1, __ATOMIC_RELEASE);
+}
+
+static void snapshot(int source, SoakStats *out) {
+    uint32_t before, after;
+    do {
+        before = __atomic_load_n(&statsSeq[source], __ATOMIC_ACQUIRE);
+        *out = stats[source];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&statsSeq[source], __ATOMIC_RELAXED);
+    } while ((before & 1) || before != after);
+}
+
+void soak_enable(void) {
+    memset(stats, 0, sizeof(stats));
+    memset(statsSeq, 0, sizeof(statsSeq));
+    soakStartUs = timing_now_us();
+    soakEnabled = 1;
+}
+
+static void closeWindow(SoakStats *s) {
+    if (s->windowSamples == 0)
+        return;
+
+    for (int a = 0; a < INPUT_AXIS_COUNT; a++)
+        s->lastWindow[a] = s->windowSum[a] / (double)s->windowSamples;
+
+    if (!s->haveBaseline) {
+        memcpy(s->baseline, s->lastWindow, sizeof(s->baseline));
+        s->haveBaseline = 1;
+    }
+
+    for (int a = 0; a < INPUT_AXIS_COUNT; a++) {
+        double d = s->lastWindow[a] - s->baseline[a];
+        if (d < 0) d = -d;
+        if (d > s->maxDrift[a]) s->maxDrift[a] = d;
+        s->windowSum[a] = 0.0;
+    }
+    s->windowSamples = 0;
+}
+
+void soak_sample(int source, const GamepadState *g, uint64_t nowUs) {
+    if (source < 0 || source >= SOAK_MAX_SOURCES)
+        return;
+
+    SoakStats *s = &stats[source];
+    beginWrite(source);
+
+    if (s->samples == 0) {
+        s->firstUs = nowUs;
+        s->windowStartUs = nowUs;
+        for (int a = 0; a < INPUT_AXIS_COUNT; a++) {
+            s->shift[a] = g->axes[a];
+            s->min[a] = g->axes[a];
+            s->max[a] = g->axes[a];
+        }
+    } else if (!s->resumed) {
+        uint64_t gap = nowUs - s->lastUs;
+        if (gap > s->maxGapUs) s->maxGapUs = gap;
+        if (gap > SOAK_GAP_US) s->gaps++;
+    }
+    s->resumed = 0;
+    s->samples++;
+    s->lastUs = nowUs;
+
+    for (int a = 0; a < INPUT_AXIS_COUNT; a++) {
+        double d = g->axes[a] - s->shift[a];
+        s->sum[a] += d;
+        s->sumSq[a] += d * d;
+        s->windowSum[a] += g->axes[a];
+        s->min[a] = g->axes[a] < s->min[a] ? g->axes[a] : s->min[a];
+        s->max[a] = g->axes[a] > s->max[a] ? g->axes[a] : s->max[a];
+    }
+    s->windowSamples++;
+
+    if (nowUs - s->windowStartUs >= SOAK_WINDOW_US) {
+        closeWindow(s);
+        s->windowStartUs = nowUs;
+    }
+
+    // Only buttons that changed need any work
+    uint32_t changed = g->buttons ^ s->lastButtons;
+    while (changed) {
+        int b = __builtin_ctz(changed);
+        changed &= changed - 1;
+
+        if (g->buttons & (1u << b)) {
+            s->presses[b]++;
+            s->pressStartUs[b] = nowUs;
+        } else {
+            uint64_t held = nowUs - s->pressStartUs[b];
+            if (held > s->longestHoldUs[b]) s->longestHoldUs[b] = held;
+        }
+    }
+    s->lastButtons = g->buttons;
+    endWrite(source);
+}
+
+void soak_connect(int source, uint16_t vendorID, uint16_t productID) {
+    if (!soakEnabled || source < 0 || source >= SOAK_MAX_SOURCES)
+        return;
+
+    SoakStats *s = &stats[source];
+    beginWrite(source);
+
+    // Same pad coming back keeps its stats (that's what disconnects counts), anything else starts over
+    int used = s->samples || s->disconnects;
+    if (used && (s->vendorID != vendorID || s->productID != productID)) {
+        uint32_t replaced = s->replaced + 1;
+        memset(s, 0, sizeof(*s));
+        s->replaced = replaced;
+    }
+    s->vendorID = vendorID;
+    s->productID = productID;
+    s->resumed = s->samples != 0;
+
+    endWrite(source);
+}
+
+void soak_disconnect(int source) {
+    if (!soakEnabled || source < 0 || source >= SOAK_MAX_SOURCES)
+        return;
+
+    SoakStats *s = &stats[source];
+    beginWrite(source);
+    s->disconnects++;
+
+    // Whatever was held ends with the disconnect
+    for (int b = 0; b < SOAK_BUTTONS; b++) {
+        if (s->lastButtons & (1u << b)) {
+            uint64_t held = s->lastUs - s->pressStartUs[b];
+            if (held > s->longestHoldUs[b]) s->longestHoldUs[b] = held;
+        }
+    }
+    s->lastButtons = 0;
+    endWrite(source);
+}
+
+static void writeSource(FILE *fp, int source, const SoakStats *s) {
+    const char *backend = source < MAX_HID_DEVICES ? "raw" : "xinput";
+    int slot = source < MAX_HID_DEVICES ? source : source - MAX_HID_DEVICES;
+
+    double seconds = (double)(s->lastUs - s->firstUs) / 1e6;
+    fprintf(fp, "[%s %d] %04X:%04X", backend, slot, s->vendorID, s->productID);
+    if (s->replaced)
+        fprintf(fp, " (slot reused, %u earlier device(s) not included)", s->replaced);
+    fprintf(fp, "\n");
+
+    fprintf(fp, "  samples %llu, %.1f/s, max gap %.1f ms, gaps > %llu ms: %llu, disconnects: %u\n",
+        (unsigned long long)s->samples,
+        seconds > 0 ? (double)(s->samples - 1) / seconds : 0.0,
+        s->maxGapUs / 1000.0, SOAK_GAP_US / 1000, (unsigned long long)s->gaps, s->disconnects);
+
+    if (s->samples == 0)
+        return;
+
+    fprintf(fp, "  axis     mean   stddev      min      max  drift(max)  drift(last)\n");
+    for (int a = 0; a < INPUT_AXIS_COUNT; a++) {
+        double n = (double)s->samples;
+        double mean = s->sum[a] / n;
+        double var = s->sumSq[a] / n - mean * mean;
+        if (var < 0) var = 0;
+
+        double lastDrift = s->haveBaseline ? s->lastWindow[a] - s->baseline[a] : 0.0;
+        fprintf(fp, "  %-4s %+8.4f %8.4f %+8.3f %+8.3f %11.4f %+12.4f\n",
+            axisNames[a], mean + s->shift[a], sqrt(var), s->min[a], s->max[a],
+            s->maxDrift[a], lastDrift);
+    }
+
+    fprintf(fp, "  buttons:");
+    int any = 0;
+    for (int b = 0; b < SOAK_BUTTONS; b++) {
+        if (!s->presses[b]) continue;
+        fprintf(fp, " %s=%u (longest %.1fs)", buttonNames[b] ? buttonNames[b] : "?",
+            s->presses[b], s->longestHoldUs[b] / 1e6);
+        any = 1;
+    }
+    fprintf(fp, any ? "\n" : " none pressed\n");
+
+    // Held past the limit, counting a press that is still down as of the last report
+    fprintf(fp, "  stuck:");
+    any = 0;
+    for (int b = 0; b < SOAK_BUTTONS; b++) {
+        uint64_t held = s->longestHoldUs[b];
+        if ((s->lastButtons & (1u << b)) && s->lastUs - s->pressStartUs[b] > held)
+            held = s->lastUs - s->pressStartUs[b];
+        if (held < SOAK_STUCK_US) continue;
+        fprintf(fp, " %s (%.0fs)", buttonNames[b] ? buttonNames[b] : "?", held / 1e6);
+        any = 1;
+    }
+    fprintf(fp, any ? "\n" : " none\n");
+}
+
+int soak_write_report(const char *path) {
+    if (!soakEnabled)
+        return 0;
+
+    FILE *fp = fopen(path, "w");
+    if (!fp) return -1;
+
+    uint64_t nowUs = timing_now_us();
+    uint64_t elapsed = (nowUs - soakStartUs) / 1000000;
+    fprintf(fp, "Soak summary after %lluh %02llum %02llus\n\n",
+        (unsigned long long)(elapsed / 3600), (unsigned long long)(elapsed / 60 % 60),
+        (unsigned long long)(elapsed % 60));
+
+    int any = 0;
+    SoakStats copy;
+    for (int i = 0; i < SOAK_MAX_SOURCES; i++) {
+        snapshot(i, &copy);
+        if (copy.samples == 0 && copy.disconnects == 0)
+            continue;
+        writeSource(fp, i, &copy);
+        fprintf(fp, "\n");
+        any = 1;
+    }
+    if (!any)
+        fprintf(fp, "No controller reported anything.\n");
+
+    fclose(fp);
+    return 0;
+}
@@ -0,0 +1,129 @@
+#ifdef TRACE_ENABLED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <trace.h>
+#include <timing.h>
+
+typedef struct {
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+} TraceEvent;
+
+typedef struct {
+    const char *threadName;
+    int tid;
+    uint64_t count;     // total events ever written, published with release order
+    TraceEvent events[TRACE_BUFFER_EVENTS];
+} TraceBuffer;
+
+static TraceBuffer *buffers[TRACE_MAX_THREADS];
+static int bufferCount = 0;
+static __thread TraceBuffer *localBuffer = NULL;
+static __thread int localDisabled = 0;
+
+// First event on a thread allocates its buffer and claims a slot for the exporter
+static TraceBuffer *acquireBuffer(void) {
+    if (localBuffer || localDisabled)
+        return localBuffer;
+
+    int slot = __atomic_fetch_add(&bufferCount, 1, __ATOMIC_ACQ_REL);
+    if (slot >= TRACE_MAX_THREADS) {
+        localDisabled = 1;
+        return NULL;
+    }
+
+    TraceBuffer *buf = calloc(1, sizeof(TraceBuffer));
+    if (!buf) {
+        localDisabled = 1;
+        return NULL;
+    }
+    buf->tid = slot + 1;
+    __atomic_store_n(&buffers[slot], buf, __ATOMIC_RELEASE);
+    localBuffer = buf;
+    return buf;
+}
+
+TraceScope trace_scope_begin(const char *name) {
+    TraceScope scope = { name, timing_ticks() };
+    return scope;
+}
+
+void trace_scope_end(TraceScope *scope) {
+    uint64_t end = timing_ticks();
+    TraceBuffer *buf = localBuffer ? localBuffer : acquireBuffer();
+    if (!buf) return;
+
+    // Only this thread writes count, so a relaxed read is enough here
+    uint64_t n = __atomic_load_n(&buf->count, __ATOMIC_RELAXED);
+    TraceEvent *ev = &buf->events[n % TRACE_BUFFER_EVENTS];
+    ev->name  = scope->name;
+    ev->start = scope->start;
+    ev->end   = end;
+    __atomic_store_n(&buf->count, n + 1, __ATOMIC_RELEASE);
+}
+
+void trace_thread_name(const char *name) {
+    TraceBuffer *buf = acquireBuffer();
+    if (buf) buf->threadName = name;
+}
+
+// Convert ticks to microseconds with sub-microsecond precision for the JSON "ts"/"dur" fields
+static double ticksToUs(uint64_t ticks, uint64_t base) {
+    return (double)(ticks - base) * 1e6 / (double)timing_ticks_per_sec();
+}
+
+/* Meant to be called once the pipeline has stopped. Threads that are still
+recording while this runs may have their newest events torn or missing. */
+int trace_export(const char *path) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) return -1;
+
+    int threads = __atomic_load_n(&bufferCount, __ATOMIC_ACQUIRE);
+    if (threads > TRACE_MAX_THREADS) threads = TRACE_MAX_THREADS;
+
+    /* Rebase timestamps on the earliest start so the viewer starts at zero.
+    Events land in the ring when their scope ends, so an enclosing scope comes
+    after the ones it contains and the oldest entry isn't the earliest start. */
+    uint64_t base = UINT64_MAX;
+    for (int t = 0; t < threads; t++) {
+        TraceBuffer *buf = __atomic_load_n(&buffers[t], __ATOMIC_ACQUIRE);
+        if (!buf) continue;
+        uint64_t count = __atomic_load_n(&buf->count, __ATOMIC_ACQUIRE);
+        uint64_t i = count > TRACE_BUFFER_EVENTS ? count - TRACE_BUFFER_EVENTS : 0;
+        for (; i < count; i++) {
+            if (buf->events[i % TRACE_BUFFER_EVENTS].start < base)
+                base = buf->events[i % TRACE_BUFFER_EVENTS].start;
+        }
+    }
+    if (base == UINT64_MAX) base = 0;
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    int first = 1;
+    for (int t = 0; t < threads; t++) {
+        TraceBuffer *buf = __atomic_load_n(&buffers[t], __ATOMIC_ACQUIRE);
+        if (!buf) continue;
+
+        if (buf->threadName) {
+            fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", buf->tid, buf->threadName);
+            first = 0;
+        }
+
+        uint64_t count = __atomic_load_n(&buf->count, __ATOMIC_ACQUIRE);
+        uint64_t i = count > TRACE_BUFFER_EVENTS ? count - TRACE_BUFFER_EVENTS : 0;
+        for (; i < count; i++) {
+            const TraceEvent *ev = &buf->events[i % TRACE_BUFFER_EVENTS];
+            fprintf(fp, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n", ev->name, buf->tid,
+                ticksToUs(ev->start, base), ticksToUs(ev->end, ev->start));
+            first = 0;
+        }
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include <string.h>
+#include <xinputPoller.h>
+
+void xpoll_init(XPoller *p, XPollGetStateFn getState) {
+    memset(p, 0, sizeof(XPoller));
+    p->getState = getState;
+
+    // Everything starts due so pads already plugged in are found by the first probe
+    for (int i = 0; i < XPOLL_MAX_SLOTS; i++)
+        p->slots[i].backoffUs = XPOLL_BACKOFF_MIN_US;
+}
+
+void xpoll_begin(XPoller *p, uint64_t nowUs) {
+    p->nowUs = nowUs;
+}
+
+static void scheduleProbe(XPollSlot *s, uint64_t nowUs) {
+    s->nextProbeUs = nowUs + s->backoffUs;
+    s->backoffUs *= 2;
+    if (s->backoffUs > XPOLL_BACKOFF_MAX_US)
+        s->backoffUs = XPOLL_BACKOFF_MAX_US;
+}
+
+XPollResult xpoll_slot(XPoller *p, int slot, XPollRawState *out) {
+    XPollSlot *s = &p->slots[slot];
+
+    // Empty slots belong to the probe until it finds something
+    if (!s->connected && !__atomic_load_n(&s->found, __ATOMIC_ACQUIRE))
+        return XPOLL_SKIPPED;
+
+    XPollGetStateFn getState = __atomic_load_n(&p->getState, __ATOMIC_RELAXED);
+    p->calls++;
+    if (getState((uint32_t)slot, out) != 0) {
+        // Hand the slot back, rearm first so the probe sees it with the slot
+        __atomic_store_n(&s->rearm, 1, __ATOMIC_RELAXED);
+        if (s->connected) {
+            // Just unplugged, the probe checks back quickly in case it's a replug
+            __atomic_store_n(&s->connected, 0, __ATOMIC_RELEASE);
+            return XPOLL_DISCONNECTED;
+        }
+        __atomic_store_n(&s->found, 0, __ATOMIC_RELEASE);
+        return XPOLL_EMPTY;
+    }
+
+    if (s->connected && out->packetNumber == s->lastPacket) {
+        p->skips++;
+        return XPOLL_UNCHANGED;
+    }
+
+    if (!s->connected) {
+        // connected before found, so the probe never sees the slot as free in between
+        __atomic_store_n(&s->connected, 1, __ATOMIC_RELEASE);
+        __atomic_store_n(&s->found, 0, __ATOMIC_RELEASE);
+    }
+    s->lastPacket = out->packetNumber;
+    p->decodes++;
+    return XPOLL_CHANGED;
+}
+
+int xpoll_probe(XPoller *p, uint64_t nowUs) {
+    int foundCount = 0;
+
+    for (int i = 0; i < XPOLL_MAX_SLOTS; i++) {
+        XPollSlot *s = &p->slots[i];
+
+        // found first: once it reads 0 again, the connected store before it is visible too
+        if (__atomic_load_n(&s->found, __ATOMIC_ACQUIRE) ||
+            __atomic_load_n(&s->connected, __ATOMIC_ACQUIRE))
+            continue;
+
+        if (__atomic_exchange_n(&s->rearm, 0, __ATOMIC_ACQUIRE)) {
+            s->backoffUs = XPOLL_BACKOFF_MIN_US;
+            scheduleProbe(s, nowUs);
+        }
+        if (nowUs < s->nextProbeUs)
+            continue;
+
+        XPollGetStateFn getState = __atomic_load_n(&p->getState, __ATOMIC_RELAXED);
+        XPollRawState state;
+        p->probes++;
+        if (getState((uint32_t)i, &state) != 0) {
+            scheduleProbe(s, nowUs);
+            continue;
+        }
+
+        // Next time this slot empties out it starts from the short backoff
+        s->backoffUs = XPOLL_BACKOFF_MIN_US;
+        __atomic_store_n(&s->found, 1, __ATOMIC_RELEASE);
+        foundCount++;
+    }
+    return foundCount;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <stdio.h>
+#include <math.h>
+
+/* Tiny assertion helpers shared by the tests in this folder. Every test is a
+plain program that builds and runs on Linux (see `make test`), failures are
+counted and reported and the exit code is non-zero if any failed. */
+
+static int checkFailures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+        checkFailures++; \
+    } \
+} while (0)
+
+#define CHECK_NEAR(a, b, tol) do { \
+    double checkA_ = (a), checkB_ = (b); \
+    if (fabs(checkA_ - checkB_) > (tol)) { \
+        printf("%s:%d: CHECK_NEAR failed: %s = %f, expected %f (+-%f)\n", \
+            __FILE__, __LINE__, #a, checkA_, checkB_, (double)(tol)); \
+        checkFailures++; \
+    } \
+} while (0)
+
+static inline int checkReport(const char *name) {
+    if (checkFailures)
+        printf("%s: %d check(s) failed\n", name, checkFailures);
+    else
+        printf("%s: ok\n", name);
+    return checkFailures != 0;
+}
@@ -0,0 +1,164 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <controllerDb.h>
+#include "check.h"
+
+/* Query parsing and VID/PID resolution, against a small DB written here (so
+the platform rules are pinned down) and against the bundled
+gamecontrollerdb.txt for a few pads people actually own. */
+
+static const char *testDb =
+    "# comment lines and blank lines are skipped\n"
+    "\n"
+    "03000000aaaa0000bbbb000000000000,Linux First,a:b0,leftx:a0,platform:Linux,\n"
+    "03000000aaaa0000bbbb000000000000,Windows Second,a:b1,leftx:a1,platform:Windows,\n"
+    "03000000cccc0000dddd000000000000,Mac Only,a:b2,platform:Mac OS X,\n"
+    "03000000eeee0000ffff000000000000,Odd Tokens,a:b0,leftx:a0~,lefty:a1,righttrigger:+a4,rightx:-a2,"
+        "dpup:h0.1,dpdown:h0.4,dpleft:h0.8,dpright:h0.2,guide:b12,+leftx:a0,platform:Windows,\n";
+
+static const CdbAxis *findAxis(const CdbMapping *map, int axis) {
+    for (int i = 0; i < map->axisCount; i++)
+        if (map->axes[i].mappedEnum == axis)
+            return &map->axes[i];
+    return NULL;
+}
+
+static int hasUnsupported(const CdbMapping *map, const char *text) {
+    for (int i = 0; i < map->unsupportedCount; i++)
+        if (map->unsupported[i].length == (int)strlen(text) && !memcmp(map->unsupported[i].text, text, strlen(text)))
+            return 1;
+    return 0;
+}
+
+static void testParseQuery(void) {
+    uint16_t vid = 0, pid = 0;
+
+    CHECK(cdb_parse_query("030000004c050000c405000000000000", &vid, &pid));
+    CHECK(vid == 0x054C && pid == 0x05C4);
+
+    CHECK(cdb_parse_query("  03000000260900008888000000000000", &vid, &pid));
+    CHECK(vid == 0x0926 && pid == 0x8888);
+
+    CHECK(cdb_parse_query("045e:028E", &vid, &pid));
+    CHECK(vid == 0x045E && pid == 0x028E);
+    CHECK(cdb_parse_query("054c 0ce6", &vid, &pid));
+    CHECK(vid == 0x054C && pid == 0x0CE6);
+    CHECK(cdb_parse_query("057e/2009", &vid, &pid));
+    CHECK(vid == 0x057E && pid == 0x2009);
+
+    // Trailing text after a GUID is fine (inventory files often have a name after it)
+    CHECK(cdb_parse_query("030000004c050000c405000000000000 my pad", &vid, &pid));
+
+    CHECK(!cdb_parse_query("", &vid, &pid));
+    CHECK(!cdb_parse_query("xbox", &vid, &pid));
+    CHECK(!cdb_parse_query("054c:5c4", &vid, &pid));
+    CHECK(!cdb_parse_query("054c:05c4a", &vid, &pid));
+    CHECK(!cdb_parse_query("54c:05c4", &vid, &pid));
+    CHECK(!cdb_parse_query("030000004c050000c40500000000000", &vid, &pid));     // 31 digits
+    CHECK(!cdb_parse_query("030000004c050000c4050000000000000", &vid, &pid));   // 33 digits
+}
+
+static void testResolveSmallDb(void) {
+    char path[] = "/tmp/controllerDbTestXXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    if (fd < 0) return;
+    CHECK(write(fd, testDb, strlen(testDb)) == (ssize_t)strlen(testDb));
+    close(fd);
+
+    ControllerDb db;
+    CHECK(cdb_load(&db, path) == 0);
+    unlink(path);
+
+    CdbMapping map;
+
+    // The Windows line wins even though it comes second
+    CHECK(cdb_resolve(&db, 0xAAAA, 0xBBBB, &map));
+    CHECK(map.platformMatch);
+    CHECK(map.name.length == 14 && !memcmp(map.name.text, "Windows Second", 14));
+    CHECK(map.buttonCount == 1 && map.buttons[0].buttonIndex == 1);
+    CHECK(map.axisCount == 1 && map.axes[0].sdlAxis == 1 && map.axes[0].usage == 0x31);
+
+    // No Windows line, the first one is used
+    CHECK(cdb_resolve(&db, 0xCCCC, 0xDDDD, &map));
+    CHECK(!map.platformMatch);
+    CHECK(map.platform.length == 8 && !memcmp(map.platform.text, "Mac OS X", 8));
+
+    CHECK(!cdb_resolve(&db, 0x1234, 0x5678, &map));
+    CHECK(cdb_find(&db, 0x1234, 0x5678) == NULL);
+
+    CHECK(cdb_resolve(&db, 0xEEEE, 0xFFFF, &map));
+
+    // Inverted axes map to their plain index, half axes and unknown names don't map
+    const CdbAxis *lx = findAxis(&map, INPUT_AXIS_LEFT_X);
+    CHECK(lx && lx->sdlAxis == 0 && lx->usage == 0x30 && lx->inverted);
+    const CdbAxis *ly = findAxis(&map, INPUT_AXIS_LEFT_Y);
+    CHECK(ly && ly->sdlAxis == 1 && !ly->inverted);
+    CHECK(findAxis(&map, INPUT_AXIS_RT) == NULL);
+    CHECK(findAxis(&map, INPUT_AXIS_RIGHT_X) == NULL);
+    CHECK(map.axisCount == 2);
+
+    CHECK(map.hatDpad);
+    CHECK(hasUnsupported(&map, "righttrigger:+a4"));
+    CHECK(hasUnsupported(&map, "rightx:-a2"));
+    CHECK(hasUnsupported(&map, "guide:b12"));
+    CHECK(hasUnsupported(&map, "+leftx:a0"));
+
+    cdb_free(&db);
+}
+
+static void testResolveBundledDb(void) {
+    ControllerDb db;
+    CHECK(cdb_load(&db, CDB_DEFAULT_PATH) == 0);
+    if (!db.buckets) return;
+
+    CdbMapping map;
+
+    // DualShock 4, every axis and the face buttons are plain indices
+    CHECK(cdb_resolve(&db, 0x054C, 0x05C4, &map));
+    CHECK(map.platformMatch);
+    CHECK(map.axisCount == 6);
+    CHECK(map.hatDpad);
+    const CdbAxis *lt = findAxis(&map, INPUT_AXIS_LT);
+    CHECK(lt && lt->sdlAxis == 3);
+    const CdbAxis *ry = findAxis(&map, INPUT_AXIS_RIGHT_Y);
+    CHECK(ry && ry->sdlAxis == 5 && !ry->inverted);
+
+    // Cyber Gadget GameCube: righty:a3~ still maps to axis 3
+    CHECK(cdb_resolve(&db, 0x0926, 0x8888, &map));
+    CHECK(map.platformMatch);
+    CHECK(map.axisCount == 6);
+    ry = findAxis(&map, INPUT_AXIS_RIGHT_Y);
+    CHECK(ry && ry->sdlAxis == 3 && ry->usage == 0x33 && ry->inverted);
+    CHECK(!hasUnsupported(&map, "righty:a3~"));
+
+    // Batch output, one line per query
+    FILE *in = tmpfile();
+    FILE *out = tmpfile();
+    CHECK(in && out);
+    if (in && out) {
+        fputs("# inventory\n03000000260900008888000000000000\n054c:05c4\nnot a guid\n1234:5678\n", in);
+        rewind(in);
+        CHECK(cdb_resolve_batch(&db, in, out) == 3);
+
+        char line[1024];
+        rewind(out);
+        CHECK(fgets(line, sizeof(line), out) && strstr(line, "0926:8888") && strstr(line, "inverted=righty\t"));
+        CHECK(fgets(line, sizeof(line), out) && strstr(line, "054C:05C4") && strstr(line, "inverted=-\t") && strstr(line, "dpad=hat"));
+        CHECK(fgets(line, sizeof(line), out) && strstr(line, "invalid query"));
+        CHECK(fgets(line, sizeof(line), out) && strstr(line, "not in DB"));
+        CHECK(!fgets(line, sizeof(line), out));
+    }
+    if (in) fclose(in);
+    if (out) fclose(out);
+
+    cdb_free(&db);
+}
+
+int main(void) {
+    testParseQuery();
+    testResolveSmallDb();
+    testResolveBundledDb();
+    return checkReport("controllerDbTest");
+}
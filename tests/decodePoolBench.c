@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <decodePool.h>
+#include <timing.h>
+
+/* Decode pool scaling. A synthetic parseReport burns a fixed amount of CPU
+per report, sized once like the fast decoders and once like the generic HidP
+path. 32 pads are fed round-robin the way WM_INPUT interleaves them, first
+decoded inline on the producer thread and then through the pool at 1 to 8
+workers. Throughput only scales with the cores the machine actually has, so
+the core count is printed with the results, along with whether 2 or more
+workers beat inline at all (the bar for --decode-threads to be worth using). */
+
+#define BENCH_PADS MAX_HID_DEVICES
+#define BENCH_REPORTS 400000   // total per run, spread over the pads
+
+static HidRecord records[BENCH_PADS];
+static uint32_t workIterations;
+static volatile uint32_t sink;
+
+static __attribute__((noinline)) uint32_t burn(uint32_t iterations, uint32_t x) {
+    for (uint32_t i = 0; i < iterations; i++)
+        x = x * 1664525u + 1013904223u;
+    return x;
+}
+
+void parseReport(HidRecord *dev, const BYTE *report, UINT size) {
+    uint32_t seq;
+    memcpy(&seq, report + 4, sizeof(seq));
+    uint32_t x = burn(workIterations, seq ^ size);
+
+    dev->state->connected = 1;
+    dev->state->buttons = seq;
+    dev->state->axes[0] = (float)(x & 0xFF);
+}
+
+static double nsPerIteration(void) {
+    uint64_t start = timing_ticks();
+    sink = burn(20000000, sink);
+    return timing_ticks_to_us(timing_ticks() - start) * 1000.0 / 20000000.0;
+}
+
+// Reports per second through `threads` workers, 0 decodes inline
+static double run(int threads) {
+    memset(records, 0, sizeof(records));
+    for (int i = 0; i < BENCH_PADS; i++) {
+        records[i].state = &records[i].shadow;
+        records[i].status = DEV_READY;
+        decode_pool_attach(&records[i], 64);
+    }
+    if (threads && decode_pool_start(threads, records, BENCH_PADS) != 0)
+        return 0;
+
+    BYTE report[64];
+    memset(report, 0, sizeof(report));
+
+    uint64_t start = timing_ticks();
+    for (uint32_t k = 0; k < BENCH_REPORTS; k++) {
+        HidRecord *dev = &records[k % BENCH_PADS];
+        memcpy(report + 4, &k, sizeof(k));
+
+        if (!threads) {
+            parseReport(dev, report, sizeof(report));
+            continue;
+        }
+        // Retry instead of dropping, so every run decodes the same amount
+        while (!decode_pool_push(dev, report, sizeof(report)))
+            Sleep(0);
+    }
+
+    if (threads) {
+        for (int i = 0; i < BENCH_PADS; i++)
+            while (__atomic_load_n(&records[i].queue.head, __ATOMIC_ACQUIRE) != records[i].queue.tail)
+                Sleep(0);
+    }
+    double seconds = timing_ticks_to_us(timing_ticks() - start) / 1e6;
+
+    if (threads) {
+        for (int i = 0; i < BENCH_PADS; i++) {
+            __atomic_store_n(&records[i].status, DEV_RETIRING, __ATOMIC_SEQ_CST);
+            decode_pool_wake(&records[i]);
+        }
+        for (int i = 0; i < BENCH_PADS; i++)
+            while (!__atomic_load_n(&records[i].decodeAck, __ATOMIC_ACQUIRE))
+                Sleep(0);
+        decode_pool_stop();
+    }
+    for (int i = 0; i < BENCH_PADS; i++)
+        decode_pool_detach(&records[i]);
+    return BENCH_REPORTS / seconds;
+}
+
+int main(void) {
+    const struct { const char *name; double ns; } loads[] = {
+        { "fast-path sized (100 ns)", 100.0 },
+        { "HidP sized (2 us)", 2000.0 },
+    };
+    const int threadCounts[] = { 0, 1, 2, 4, 8 };
+    double perIteration = nsPerIteration();
+
+    printf("decode pool: %d pads, %d reports per run, %ld cores online\n",
+        BENCH_PADS, BENCH_REPORTS, sysconf(_SC_NPROCESSORS_ONLN));
+
+    for (size_t l = 0; l < sizeof(loads) / sizeof(loads[0]); l++) {
+        workIterations = (uint32_t)(loads[l].ns / perIteration);
+        printf("  %s\n", loads[l].name);
+
+        double inlineRate = 0, bestRatio = 0;
+        int bestThreads = 0;
+        for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++) {
+            double rate = run(threadCounts[t]);
+            if (threadCounts[t] == 0) {
+                inlineRate = rate;
+                printf("    inline     %8.3f Mreports/s  (%.0f ns/report)\n", rate / 1e6, 1e9 / rate);
+                continue;
+            }
+            printf("    %d worker%s  %8.3f Mreports/s  %.2fx inline\n", threadCounts[t],
+                threadCounts[t] == 1 ? " " : "s", rate / 1e6, rate / inlineRate);
+            if (threadCounts[t] >= 2 && rate / inlineRate > bestRatio) {
+                bestRatio = rate / inlineRate;
+                bestThreads = threadCounts[t];
+            }
+        }
+
+        if (bestRatio > 1.0)
+            printf("    verdict: %d workers beat inline, %.2fx\n", bestThreads, bestRatio);
+        else
+            printf("    verdict: no worker count beats inline here (best %.2fx), decode inline\n", bestRatio);
+    }
+    return 0;
+}
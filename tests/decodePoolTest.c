@@ -0,0 +1,134 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <decodePool.h>
+#include "check.h"
+
+/* Decode pool on pthreads (tests/winThreads.c). Every report carries its
+device slot and a sequence number, and the stand-in parseReport checks that
+each device is decoded in order, without gaps and always on the same worker.
+The message-thread side keeps reading published states while the workers run
+and checks none of them is torn. Runs with USB-sized DS4 reports and again
+with the 547-byte ones a DS4 sends over Bluetooth. */
+
+#define DEVICES MAX_HID_DEVICES
+#define REPORTS_PER_DEVICE 2000
+
+static HidRecord records[DEVICES];
+static uint32_t decoded[DEVICES];
+static pthread_t owner[DEVICES];
+static int ownerSet[DEVICES];
+static LONG orderErrors;
+static LONG ownerErrors;
+static UINT reportBytes;
+
+// Stand-in for rawInput.c's parseReport: every axis and the buttons carry the sequence number
+void parseReport(HidRecord *dev, const BYTE *report, UINT size) {
+    int slot = (int)(dev - records);
+    uint32_t seq;
+    memcpy(&seq, report + 4, sizeof(seq));
+
+    if (size != reportBytes || report[0] != (BYTE)slot || seq != decoded[slot] + 1)
+        __atomic_add_fetch(&orderErrors, 1, __ATOMIC_RELAXED);
+    decoded[slot] = seq;
+
+    if (!ownerSet[slot]) {
+        owner[slot] = pthread_self();
+        ownerSet[slot] = 1;
+    } else if (!pthread_equal(owner[slot], pthread_self())) {
+        __atomic_add_fetch(&ownerErrors, 1, __ATOMIC_RELAXED);
+    }
+
+    dev->state->connected = 1;
+    dev->state->buttons = seq;
+    for (int a = 0; a < INPUT_AXIS_COUNT; a++)
+        dev->state->axes[a] = (float)seq;
+}
+
+static void runPool(int threads, UINT bytes) {
+    memset(records, 0, sizeof(records));
+    reportBytes = bytes;
+    memset(decoded, 0, sizeof(decoded));
+    memset(ownerSet, 0, sizeof(ownerSet));
+    orderErrors = 0;
+    ownerErrors = 0;
+
+    for (int i = 0; i < DEVICES; i++) {
+        records[i].state = &records[i].shadow;
+        records[i].status = DEV_READY;
+        CHECK(decode_pool_attach(&records[i], bytes) == 0);
+    }
+
+    CHECK(!decode_pool_active());
+    CHECK(decode_pool_start(threads, records, DEVICES) == 0);
+    CHECK(decode_pool_active());
+
+    uint32_t sent[DEVICES] = { 0 };
+    int torn = 0, reads = 0;
+    static BYTE report[1024];
+    memset(report, 0, sizeof(report));
+
+    // Longer than the device's slots: refused up front instead of overrunning them
+    CHECK(!decode_pool_push(&records[0], report, bytes + 1));
+
+    for (uint32_t k = 0; k < REPORTS_PER_DEVICE; k++) {
+        for (int i = 0; i < DEVICES; i++) {
+            uint32_t seq = sent[i] + 1;
+            report[0] = (BYTE)i;
+            memcpy(report + 4, &seq, sizeof(seq));
+
+            // A full queue drops, like WndProc does. The test wants every report, so it retries.
+            while (!decode_pool_push(&records[i], report, bytes))
+                Sleep(0);
+            sent[i] = seq;
+
+            if ((k & 63) == 0) {
+                GamepadState g;
+                decode_pool_read(&records[i], &g, &records[i].readSeq);
+                for (int a = 0; a < INPUT_AXIS_COUNT; a++)
+                    torn += g.axes[a] != (float)g.buttons;
+                reads++;
+            }
+        }
+    }
+
+    // Wait for the workers to catch up
+    for (int i = 0; i < DEVICES; i++)
+        while (__atomic_load_n(&records[i].queue.head, __ATOMIC_ACQUIRE) != records[i].queue.tail)
+            Sleep(0);
+
+    int stale = 0;
+    for (int i = 0; i < DEVICES; i++) {
+        GamepadState g;
+        decode_pool_read(&records[i], &g, &records[i].readSeq);
+        stale += g.buttons != sent[i] || !g.connected;
+    }
+
+    CHECK(reads > 0);
+    CHECK(torn == 0);
+    CHECK(orderErrors == 0);
+    CHECK(ownerErrors == 0);
+    CHECK(stale == 0);
+
+    // Retiring: every worker acks its records and drops what is still queued
+    for (int i = 0; i < DEVICES; i++) {
+        __atomic_store_n(&records[i].status, DEV_RETIRING, __ATOMIC_SEQ_CST);
+        decode_pool_wake(&records[i]);
+    }
+    for (int i = 0; i < DEVICES; i++)
+        while (!__atomic_load_n(&records[i].decodeAck, __ATOMIC_ACQUIRE))
+            Sleep(0);
+
+    decode_pool_stop();
+    CHECK(!decode_pool_active());
+    for (int i = 0; i < DEVICES; i++)
+        decode_pool_detach(&records[i]);
+}
+
+int main(void) {
+    const int threadCounts[] = { 1, 2, 3, 4, 8 };
+    for (size_t i = 0; i < sizeof(threadCounts) / sizeof(threadCounts[0]); i++)
+        runPool(threadCounts[i], 64);
+    runPool(2, 547);
+    return checkReport("decodePoolTest");
+}
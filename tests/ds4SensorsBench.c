@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <string.h>
+#include <ds4Sensors.h>
+#include <timing.h>
+
+/* Several DS4s at 1 kHz, decoded round-robin the way WM_INPUT interleaves
+them. Reports how long one report takes and how many pads that would keep up
+with on one core. */
+
+#define BENCH_PADS 8
+#define BENCH_REPORTS_PER_PAD 250000
+
+int main(void) {
+    static uint8_t reports[BENCH_PADS][64];
+    Ds4ImuFilter filters[BENCH_PADS];
+    GamepadSensors sensors[BENCH_PADS];
+
+    for (int p = 0; p < BENCH_PADS; p++) {
+        memset(reports[p], 0, sizeof(reports[p]));
+        reports[p][0] = DS4_REPORT_USB;
+        ds4_imu_reset(&filters[p]);
+    }
+
+    uint64_t start = timing_ticks();
+    for (int i = 0; i < BENCH_REPORTS_PER_PAD; i++) {
+        for (int p = 0; p < BENCH_PADS; p++) {
+            uint8_t *r = reports[p];
+            uint16_t ts = (uint16_t)(i * 188);
+
+            // Slowly wobbling motion so the filter does real work on every report
+            int16_t gyro = (int16_t)((i * 37 + p * 1000) & 0x3FFF) - 0x2000;
+            int16_t accelY = (int16_t)(8192 - ((i + p) & 0xFF));
+            r[10] = ts & 0xFF; r[11] = ts >> 8;
+            r[13] = gyro & 0xFF; r[14] = (uint16_t)gyro >> 8;
+            r[15] = r[13]; r[16] = r[14];
+            r[21] = accelY & 0xFF; r[22] = (uint16_t)accelY >> 8;
+            r[23] = (uint8_t)(i + p);
+
+            ds4_imu_decode(&filters[p], r, sizeof(reports[p]), &sensors[p]);
+        }
+    }
+    uint64_t elapsed = timing_ticks() - start;
+
+    double total = (double)BENCH_PADS * BENCH_REPORTS_PER_PAD;
+    double nsPerReport = timing_ticks_to_us(elapsed) * 1000.0 / total;
+
+    // Keep the results alive so the loop isn't optimized away
+    volatile float sink = 0;
+    for (int p = 0; p < BENCH_PADS; p++)
+        sink += sensors[p].pitch + sensors[p].roll + sensors[p].yaw;
+
+    printf("ds4 imu: %d pads x %d reports, %.1f ns/report, %.2f%% of a core for %d pads at 1 kHz (%.0f pads max)\n",
+        BENCH_PADS, BENCH_REPORTS_PER_PAD, nsPerReport,
+        nsPerReport * BENCH_PADS * 1000.0 / 1e9 * 100.0, BENCH_PADS,
+        1e9 / (nsPerReport * 1000.0));
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include <string.h>
+#include <ds4Sensors.h>
+#include "check.h"
+
+/* DS4 reports laid out byte for byte as the pad sends them. USB is report
+0x01 (64 bytes), Bluetooth is report 0x11 (78 bytes) with two extra header
+bytes, so every field sits 2 bytes later. Timestamp, gyro and accel are the
+only fields the decoder reads, the rest is a pad lying still. */
+
+// USB, flat on the desk: timestamp 0x1234, gyro (-3, 2, 1), accel (120, 8190, -60)
+static const uint8_t usbFlat[64] = {
+    0x01, 0x80, 0x7F, 0x81, 0x80, 0x08, 0x00, 0x00, 0x00, 0x00,
+    0x34, 0x12, 0x1B, 0xFD, 0xFF, 0x02, 0x00, 0x01, 0x00, 0x78,
+    0x00, 0xFE, 0x1F, 0xC4, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1B, 0x00, 0x00, 0x01, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80,
+    0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00
+};
+
+// Bluetooth, tipped 45 degrees towards the player: timestamp 0xA0B0, gyro (5, -4, 0), accel (0, 5793, 5793)
+static const uint8_t btTilted[78] = {
+    0x11, 0xC0, 0x00, 0x80, 0x80, 0x80, 0x80, 0x08, 0x00, 0x00,
+    0x00, 0x00, 0xB0, 0xA0, 0x1A, 0x05, 0x00, 0xFC, 0xFF, 0x00,
+    0x00, 0x00, 0x00, 0xA1, 0x16, 0xA1, 0x16, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x1B, 0x00, 0x00, 0x01, 0x00, 0x80, 0x00, 0x00,
+    0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00,
+    0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+#define RAD_TO_DEG 57.29577951308232
+#define TICK_US (16.0 / 3.0)
+
+// Rewrite the IMU fields of a USB report in place, used to play back motion
+static void setImu(uint8_t *report, uint16_t timestamp, const int16_t gyro[3], const int16_t accel[3]) {
+    report[10] = timestamp & 0xFF;
+    report[11] = timestamp >> 8;
+    for (int i = 0; i < 3; i++) {
+        report[13 + i * 2] = gyro[i] & 0xFF;
+        report[14 + i * 2] = (uint16_t)gyro[i] >> 8;
+        report[19 + i * 2] = accel[i] & 0xFF;
+        report[20 + i * 2] = (uint16_t)accel[i] >> 8;
+    }
+}
+
+static void testUsbFields(void) {
+    Ds4ImuFilter f;
+    GamepadSensors s;
+    ds4_imu_reset(&f);
+
+    CHECK(ds4_imu_decode(&f, usbFlat, sizeof(usbFlat), &s) == 1);
+    CHECK(s.present == 1);
+    CHECK(s.gyro[0] == -3 && s.gyro[1] == 2 && s.gyro[2] == 1);
+    CHECK(s.accel[0] == 120 && s.accel[1] == 8190 && s.accel[2] == -60);
+    CHECK(f.lastTimestamp == 0x1234);
+
+    // First report primes straight from gravity
+    CHECK_NEAR(s.pitch, atan2(-60, 8190) * RAD_TO_DEG, 0.1);
+    CHECK_NEAR(s.roll, atan2(-120, 8190) * RAD_TO_DEG, 0.1);
+    CHECK_NEAR(s.yaw, 0.0, 1e-6);
+}
+
+static void testBtFields(void) {
+    Ds4ImuFilter f;
+    GamepadSensors s;
+    ds4_imu_reset(&f);
+
+    CHECK(ds4_imu_decode(&f, btTilted, sizeof(btTilted), &s) == 1);
+    CHECK(s.gyro[0] == 5 && s.gyro[1] == -4 && s.gyro[2] == 0);
+    CHECK(s.accel[0] == 0 && s.accel[1] == 5793 && s.accel[2] == 5793);
+    CHECK(f.lastTimestamp == 0xA0B0);
+    CHECK_NEAR(s.pitch, 45.0, 0.1);
+    CHECK_NEAR(s.roll, 0.0, 0.1);
+}
+
+static void testRejects(void) {
+    Ds4ImuFilter f;
+    GamepadSensors s;
+    uint8_t other[64];
+    memcpy(other, usbFlat, sizeof(other));
+    other[0] = 0x05;    // output report, no IMU block
+    ds4_imu_reset(&f);
+
+    memset(&s, 0, sizeof(s));
+    CHECK(ds4_imu_decode(&f, other, sizeof(other), &s) == 0);
+    CHECK(ds4_imu_decode(&f, usbFlat, 20, &s) == 0);     // truncated
+    CHECK(ds4_imu_decode(&f, btTilted, 26, &s) == 0);    // truncated BT header
+    CHECK(ds4_imu_decode(&f, usbFlat, 0, &s) == 0);
+    CHECK(s.present == 0);
+}
+
+// 1000 reports at ~1 kHz turning at ~100 deg/s should add up to ~100 degrees of yaw
+static void testYawIntegration(void) {
+    Ds4ImuFilter f;
+    GamepadSensors s;
+    uint8_t report[64];
+    memcpy(report, usbFlat, sizeof(report));
+    ds4_imu_reset(&f);
+
+    const int16_t gyro[3] = { 0, 1638, 0 };
+    const int16_t accel[3] = { 0, 8192, 0 };
+    uint16_t ts = 0xF000;   // wraps part way through
+    setImu(report, ts, gyro, accel);
+    ds4_imu_decode(&f, report, sizeof(report), &s);
+
+    for (int i = 0; i < 1000; i++) {
+        ts += 188;
+        setImu(report, ts, gyro, accel);
+        ds4_imu_decode(&f, report, sizeof(report), &s);
+    }
+
+    double expect = 1638 / 16.384 * (1000 * 188 * TICK_US / 1e6);
+    CHECK_NEAR(s.yaw, expect, 0.5);
+    CHECK_NEAR(s.pitch, 0.0, 0.1);
+    CHECK_NEAR(s.roll, 0.0, 0.1);
+}
+
+// Timestamp wrapping from 0xFFF0 to 0x00A4 is 180 ticks, not a huge jump back
+static void testTimestampWrap(void) {
+    Ds4ImuFilter f;
+    GamepadSensors s;
+    uint8_t report[64];
+    memcpy(report, usbFlat, sizeof(report));
+    ds4_imu_reset(&f);
+
+    const int16_t still[3] = { 0, 0, 0 };
+    const int16_t turning[3] = { 0, 16384, 0 };     // 1000 deg/s
+    const int16_t accel[3] = { 0, 8192, 0 };
+    setImu(report, 0xFFF0, still, accel);
+    ds4_imu_decode(&f, report, sizeof(report), &s);
+    setImu(report, 0x00A4, turning, accel);
+    ds4_imu_decode(&f, report, sizeof(report), &s);
+
+    CHECK_NEAR(s.yaw, 1000.0 * 180 * TICK_US / 1e6, 0.01);
+}
+
+// Gravity drags pitch to the tilt the accelerometer sees, gyro silent
+static void testAccelConvergence(void) {
+    Ds4ImuFilter f;
+    GamepadSensors s;
+    uint8_t report[64];
+    memcpy(report, usbFlat, sizeof(report));
+    ds4_imu_reset(&f);
+
+    const int16_t still[3] = { 0, 0, 0 };
+    const int16_t flat[3] = { 0, 8192, 0 };
+    const int16_t tilted[3] = { 0, 5793, 5793 };
+    uint16_t ts = 0;
+    setImu(report, ts, still, flat);
+    ds4_imu_decode(&f, report, sizeof(report), &s);
+
+    // One report moves it ~1% of the way
+    setImu(report, ts += 188, still, tilted);
+    ds4_imu_decode(&f, report, sizeof(report), &s);
+    CHECK(s.pitch > 0.3 && s.pitch < 0.6);
+
+    for (int i = 0; i < 999; i++) {
+        setImu(report, ts += 188, still, tilted);
+        ds4_imu_decode(&f, report, sizeof(report), &s);
+    }
+    CHECK_NEAR(s.pitch, 45.0, 0.5);
+    CHECK_NEAR(s.roll, 0.0, 0.1);
+}
+
+int main(void) {
+    testUsbFields();
+    testBtFields();
+    testRejects();
+    testYawIntegration();
+    testTimestampWrap();
+    testAccelConvergence();
+    return checkReport("ds4SensorsTest");
+}
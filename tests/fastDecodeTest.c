@@ -0,0 +1,252 @@
+#include <string.h>
+#include <stdlib.h>
+#include <hidProfiles.h>
+#include "hidShim.h"
+#include "check.h"
+
+/* Differential test for the fast decoders. Each device goes through the real
+layout path (layout_acquire -> caps -> DB mapping -> fast_bind) on top of the
+HidP stand-in. Every report is then decoded by the fast path and by the
+generic HidP path, and the two GamepadStates have to match exactly. */
+
+#define SWEEP_REPORTS 200000
+
+// DualShock 4 (054C:05C4 / 09CC), input items of the USB report descriptor
+static const uint8_t ds4Descriptor[] = {
+    0x05, 0x01,         // Usage Page (Generic Desktop)
+    0x09, 0x05,         // Usage (Game Pad)
+    0xA1, 0x01,         // Collection (Application)
+    0x85, 0x01,         //   Report ID (1)
+    0x09, 0x30,         //   Usage (X)
+    0x09, 0x31,         //   Usage (Y)
+    0x09, 0x32,         //   Usage (Z)
+    0x09, 0x35,         //   Usage (Rz)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x26, 0xFF, 0x00,   //   Logical Maximum (255)
+    0x75, 0x08,         //   Report Size (8)
+    0x95, 0x04,         //   Report Count (4)
+    0x81, 0x02,         //   Input (Data,Var,Abs)
+    0x09, 0x39,         //   Usage (Hat switch)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x07,         //   Logical Maximum (7)
+    0x35, 0x00,         //   Physical Minimum (0)
+    0x46, 0x3B, 0x01,   //   Physical Maximum (315)
+    0x65, 0x14,         //   Unit (Degrees)
+    0x75, 0x04,         //   Report Size (4)
+    0x95, 0x01,         //   Report Count (1)
+    0x81, 0x42,         //   Input (Data,Var,Abs,Null State)
+    0x65, 0x00,         //   Unit (None)
+    0x05, 0x09,         //   Usage Page (Button)
+    0x19, 0x01,         //   Usage Minimum (1)
+    0x29, 0x0E,         //   Usage Maximum (14)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x01,         //   Logical Maximum (1)
+    0x75, 0x01,         //   Report Size (1)
+    0x95, 0x0E,         //   Report Count (14)
+    0x81, 0x02,         //   Input (Data,Var,Abs)
+    0x06, 0x00, 0xFF,   //   Usage Page (Vendor 0xFF00)
+    0x09, 0x20,         //   Usage (0x20), report counter
+    0x75, 0x06,         //   Report Size (6)
+    0x95, 0x01,         //   Report Count (1)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x7F,         //   Logical Maximum (127)
+    0x81, 0x02,         //   Input (Data,Var,Abs)
+    0x05, 0x01,         //   Usage Page (Generic Desktop)
+    0x09, 0x33,         //   Usage (Rx), L2
+    0x09, 0x34,         //   Usage (Ry), R2
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x26, 0xFF, 0x00,   //   Logical Maximum (255)
+    0x75, 0x08,         //   Report Size (8)
+    0x95, 0x02,         //   Report Count (2)
+    0x81, 0x02,         //   Input (Data,Var,Abs)
+    0x06, 0x00, 0xFF,   //   Usage Page (Vendor 0xFF00)
+    0x09, 0x21,         //   Usage (0x21), timestamp, IMU, touchpad
+    0x95, 0x36,         //   Report Count (54)
+    0x81, 0x02,         //   Input (Data,Var,Abs)
+    0xC0                // End Collection
+};
+
+// PlayStation Classic (054C:0CDA): 10 buttons, then X/Y as 2-bit 0..2 fields
+static const uint8_t psClassicDescriptor[] = {
+    0x05, 0x01,         // Usage Page (Generic Desktop)
+    0x09, 0x05,         // Usage (Game Pad)
+    0xA1, 0x01,         // Collection (Application)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x01,         //   Logical Maximum (1)
+    0x35, 0x00,         //   Physical Minimum (0)
+    0x45, 0x01,         //   Physical Maximum (1)
+    0x75, 0x01,         //   Report Size (1)
+    0x95, 0x0A,         //   Report Count (10)
+    0x05, 0x09,         //   Usage Page (Button)
+    0x19, 0x01,         //   Usage Minimum (1)
+    0x29, 0x0A,         //   Usage Maximum (10)
+    0x81, 0x02,         //   Input (Data,Var,Abs)
+    0x05, 0x01,         //   Usage Page (Generic Desktop)
+    0x09, 0x30,         //   Usage (X)
+    0x09, 0x31,         //   Usage (Y)
+    0x25, 0x02,         //   Logical Maximum (2)
+    0x45, 0x02,         //   Physical Maximum (2)
+    0x75, 0x02,         //   Report Size (2)
+    0x95, 0x02,         //   Report Count (2)
+    0x81, 0x02,         //   Input (Data,Var,Abs)
+    0x75, 0x01,         //   Report Size (1)
+    0x95, 0x02,         //   Report Count (2)
+    0x81, 0x01,         //   Input (Const), padding
+    0xC0                // End Collection
+};
+
+// Recorded DS4 USB reports, only the first 10 bytes carry input the decoders read
+static const uint8_t ds4Reports[][10] = {
+    { 0x01, 0x80, 0x7F, 0x81, 0x80, 0x08, 0x00, 0x00, 0x00, 0x00 },   // idle
+    { 0x01, 0x80, 0x7F, 0x81, 0x80, 0x20, 0x00, 0x04, 0x00, 0x00 },   // cross + dpad up, counter 1
+    { 0x01, 0x80, 0x7F, 0x81, 0x80, 0x88, 0x04, 0x08, 0xFF, 0x00 },   // triangle, L2 fully pressed
+    { 0x01, 0x00, 0xFF, 0xFF, 0x00, 0x03, 0x00, 0x0C, 0x00, 0x00 },   // sticks in the corners, dpad down-right
+    { 0x01, 0x80, 0x80, 0x80, 0x80, 0x18, 0x33, 0x10, 0x40, 0xC0 },   // square, L1 R1, share options, triggers half
+    { 0x01, 0x86, 0x79, 0x7E, 0x83, 0x08, 0xC0, 0x15, 0x00, 0x00 },   // L3 R3, PS button
+    { 0x01, 0x80, 0x80, 0x80, 0x80, 0xF7, 0xFF, 0x1B, 0xFF, 0xFF },   // every button, dpad nonsense (7 + null bit)
+    { 0x01, 0x80, 0x80, 0x80, 0x80, 0x0F, 0x00, 0x1E, 0x00, 0x00 },   // hat out of range (15)
+};
+
+// Recorded PS Classic reports, leading 0 is the report ID Windows adds
+static const uint8_t psClassicReports[][3] = {
+    { 0x00, 0x00, 0x14 },   // idle, X/Y centred
+    { 0x00, 0x02, 0x14 },   // cross
+    { 0x00, 0x00, 0x16 },   // start
+    { 0x00, 0x30, 0x10 },   // L1 R1, dpad left
+    { 0x00, 0xFF, 0x2B },   // everything
+};
+
+typedef struct {
+    const char *name;
+    uint16_t vendorID;
+    uint16_t productID;
+    const uint8_t *descriptor;
+    size_t descriptorSize;
+    const uint8_t *reports;
+    size_t reportStride;
+    size_t reportCount;
+} TestDevice;
+
+static int compareDecoders(const HidLayout *layout, const uint8_t *report, uint32_t size, const char *what) {
+    GamepadState fast, generic;
+    memset(&fast, 0, sizeof(fast));
+    memset(&generic, 0, sizeof(generic));
+
+    if (!fast_decode(&layout->fast, report, size, &fast)) {
+        printf("%s: fast path refused the report\n", what);
+        return 0;
+    }
+    hid_decode_generic(layout, report, size, &generic);
+
+    if (memcmp(&fast, &generic, sizeof(fast)) != 0) {
+        printf("%s: fast buttons %08X generic %08X, LX %f/%f LT %f/%f\n", what,
+            (unsigned)fast.buttons, (unsigned)generic.buttons,
+            fast.axes[INPUT_AXIS_LEFT_X], generic.axes[INPUT_AXIS_LEFT_X],
+            fast.axes[INPUT_AXIS_LT], generic.axes[INPUT_AXIS_LT]);
+        return 0;
+    }
+    return 1;
+}
+
+static void testDevice(const TestDevice *t) {
+    static HidShimDevice device;
+    CHECK(hidshim_build(&device, t->descriptor, t->descriptorSize) == 0);
+
+    const HidLayout *layout = layout_acquire(&device, t->vendorID, t->productID);
+    CHECK(layout != NULL);
+    if (!layout) return;
+
+    // The fast decoder has to accept the real descriptor, otherwise there is nothing to compare
+    CHECK(layout->fast.entry != NULL);
+    CHECK(layout->buttonCount > 0);
+    if (!layout->fast.entry) {
+        layout_release(layout);
+        return;
+    }
+
+    uint32_t length = layout->caps.InputReportByteLength;
+    uint8_t *report = calloc(1, length);
+
+    // Recorded reports, zero-padded to the full report length
+    for (size_t i = 0; i < t->reportCount; i++) {
+        memset(report, 0, length);
+        memcpy(report, t->reports + i * t->reportStride, t->reportStride);
+
+        char what[64];
+        snprintf(what, sizeof(what), "%s report %zu", t->name, i);
+        CHECK(compareDecoders(layout, report, length, what));
+    }
+
+    // Every other bit pattern we can think of
+    uint32_t seed = 0x12345678u ^ t->productID;
+    int mismatches = 0;
+    for (int n = 0; n < SWEEP_REPORTS && mismatches < 5; n++) {
+        for (uint32_t b = 1; b < length; b++) {
+            seed = seed * 1664525u + 1013904223u;
+            report[b] = (uint8_t)(seed >> 24);
+        }
+        report[0] = layout->fast.entry->layout->reportID;
+
+        if (!compareDecoders(layout, report, length, t->name))
+            mismatches++;
+    }
+    CHECK(mismatches == 0);
+
+    // A report for another ID never takes the fast path
+    if (length > 1) {
+        report[0] ^= 0x40;
+        GamepadState g;
+        CHECK(fast_decode(&layout->fast, report, length, &g) == 0);
+    }
+
+    free(report);
+    layout_release(layout);
+}
+
+// Same VID/PID as a DS4 but no hat switch: fast_bind must refuse it
+static void testMismatchedDescriptor(void) {
+    static uint8_t noHat[sizeof(ds4Descriptor)];
+    static HidShimDevice device;
+    size_t n = 0;
+
+    // Drop the hat input item and leave its 4 bits as constant padding
+    for (size_t i = 0; i < sizeof(ds4Descriptor);) {
+        if (ds4Descriptor[i] == 0x09 && ds4Descriptor[i + 1] == 0x39) {
+            i += 2;
+            continue;
+        }
+        if (ds4Descriptor[i] == 0x81 && ds4Descriptor[i + 1] == 0x42) {
+            noHat[n++] = 0x81;
+            noHat[n++] = 0x01;
+            i += 2;
+            continue;
+        }
+        noHat[n++] = ds4Descriptor[i++];
+    }
+
+    CHECK(hidshim_build(&device, noHat, n) == 0);
+    const HidLayout *layout = layout_acquire(&device, 0x054C, 0x05C4);
+    CHECK(layout != NULL);
+    if (!layout) return;
+
+    CHECK(layout->hatCapIndex < 0);
+    CHECK(layout->fast.entry == NULL);
+    layout_release(layout);
+}
+
+int main(void) {
+    const TestDevice devices[] = {
+        { "DualShock 4", 0x054C, 0x05C4, ds4Descriptor, sizeof(ds4Descriptor),
+            &ds4Reports[0][0], sizeof(ds4Reports[0]), sizeof(ds4Reports) / sizeof(ds4Reports[0]) },
+        { "DualShock 4 v2", 0x054C, 0x09CC, ds4Descriptor, sizeof(ds4Descriptor),
+            &ds4Reports[0][0], sizeof(ds4Reports[0]), sizeof(ds4Reports) / sizeof(ds4Reports[0]) },
+        { "PlayStation Classic", 0x054C, 0x0CDA, psClassicDescriptor, sizeof(psClassicDescriptor),
+            &psClassicReports[0][0], sizeof(psClassicReports[0]), sizeof(psClassicReports) / sizeof(psClassicReports[0]) },
+    };
+
+    for (size_t i = 0; i < sizeof(devices) / sizeof(devices[0]); i++)
+        testDevice(&devices[i]);
+    testMismatchedDescriptor();
+
+    return checkReport("fastDecodeTest");
+}
@@ -0,0 +1,320 @@
+#include <string.h>
+#include "hidShim.h"
+
+#define HIDSHIM_MAGIC 0x4D494853u   // "SHIM"
+#define HIDSHIM_MAX_USAGES 16
+#define HIDSHIM_MAX_REPORTS 8
+
+// Item value, sign-extended the way Logical Minimum/Maximum need it
+static int32_t itemSigned(const uint8_t *data, int size) {
+    switch (size) {
+        case 1: return (int8_t)data[0];
+        case 2: return (int16_t)(data[0] | (data[1] << 8));
+        case 4: return (int32_t)(data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24));
+        default: return 0;
+    }
+}
+
+static uint32_t itemUnsigned(const uint8_t *data, int size) {
+    uint32_t v = 0;
+    for (int i = 0; i < size; i++)
+        v |= (uint32_t)data[i] << (8 * i);
+    return v;
+}
+
+int hidshim_build(HidShimDevice *device, const uint8_t *descriptor, size_t length) {
+    HidShimPreparsed *p = &device->preparsed;
+    memset(p, 0, sizeof(*p));
+    p->magic = HIDSHIM_MAGIC;
+
+    // Globals
+    uint16_t usagePage = 0;
+    int32_t logicalMin = 0, logicalMax = 0;
+    uint32_t reportSize = 0, reportCount = 0;
+    uint8_t reportID = 0;
+
+    // Locals, reset after every main item
+    uint16_t usages[HIDSHIM_MAX_USAGES];
+    int usageCount = 0;
+    uint16_t usageMin = 0, usageMax = 0;
+    int haveRange = 0;
+
+    // Bits used so far per input report, every report starts after its ID byte
+    uint8_t reportIDs[HIDSHIM_MAX_REPORTS] = { 0 };
+    uint32_t reportBits[HIDSHIM_MAX_REPORTS] = { 0 };
+    int reportCountSeen = 0;
+
+    for (size_t i = 0; i < length;) {
+        uint8_t prefix = descriptor[i];
+        if (prefix == 0xFE)
+            return -1;  // long items
+
+        int size = (prefix & 3) == 3 ? 4 : (prefix & 3);
+        if (i + 1 + size > length)
+            return -1;
+        const uint8_t *data = descriptor + i + 1;
+        int type = (prefix >> 2) & 3;
+        int tag = prefix >> 4;
+        i += 1 + size;
+
+        if (type == 1) {            // global
+            switch (tag) {
+                case 0x0: usagePage = (uint16_t)itemUnsigned(data, size); break;
+                case 0x1: logicalMin = itemSigned(data, size); break;
+                case 0x2: logicalMax = itemSigned(data, size); break;
+                case 0x7: reportSize = itemUnsigned(data, size); break;
+                case 0x8: reportID = (uint8_t)itemUnsigned(data, size); break;
+                case 0x9: reportCount = itemUnsigned(data, size); break;
+                case 0xA: case 0xB: return -1;  // push/pop
+                default: break;                 // physical range, units
+            }
+            continue;
+        }
+
+        if (type == 2) {            // local
+            switch (tag) {
+                case 0x0:
+                    if (size == 4 || usageCount >= HIDSHIM_MAX_USAGES)
+                        return -1;  // extended usages aren't modelled
+                    usages[usageCount++] = (uint16_t)itemUnsigned(data, size);
+                    break;
+                case 0x1: usageMin = (uint16_t)itemUnsigned(data, size); haveRange = 1; break;
+                case 0x2: usageMax = (uint16_t)itemUnsigned(data, size); break;
+                default: break;
+            }
+            continue;
+        }
+
+        if (type != 0)
+            return -1;
+
+        // Main items. Only Input changes the input layout.
+        if (tag == 0x8) {
+            int r;
+            for (r = 0; r < reportCountSeen && reportIDs[r] != reportID; r++)
+                ;
+            if (r == reportCountSeen) {
+                if (reportCountSeen >= HIDSHIM_MAX_REPORTS)
+                    return -1;
+                reportIDs[reportCountSeen] = reportID;
+                reportBits[reportCountSeen++] = 8;
+            }
+
+            uint32_t flags = itemUnsigned(data, size);
+            int constant = flags & 1;
+            int variable = flags & 2;
+            uint32_t start = reportBits[r];
+            reportBits[r] += reportSize * reportCount;
+
+            if (!constant) {
+                if (!variable)
+                    return -1;  // array fields aren't used by any pad we test
+
+                HidShimField base = {
+                    .reportID = reportID,
+                    .isButton = reportSize == 1,
+                    .usagePage = usagePage,
+                    .bitSize = (uint16_t)reportSize,
+                    .logicalMin = logicalMin,
+                    .logicalMax = logicalMax,
+                };
+
+                if (haveRange) {
+                    if (p->fieldCount >= HIDSHIM_MAX_FIELDS)
+                        return -1;
+                    HidShimField *f = &p->fields[p->fieldCount++];
+                    *f = base;
+                    f->isRange = 1;
+                    f->usageMin = usageMin;
+                    f->usageMax = usageMax;
+                    f->bitOffset = (uint16_t)start;
+                    f->reportCount = (uint16_t)reportCount;
+                } else if (usageCount > 0) {
+                    // One cap per listed usage, the last one takes any remaining count
+                    uint32_t bit = start;
+                    for (int u = 0; u < usageCount && (uint32_t)u < reportCount; u++) {
+                        if (p->fieldCount >= HIDSHIM_MAX_FIELDS)
+                            return -1;
+                        uint32_t count = u == usageCount - 1 ? reportCount - u : 1;
+                        HidShimField *f = &p->fields[p->fieldCount++];
+                        *f = base;
+                        f->usageMin = f->usageMax = usages[u];
+                        f->bitOffset = (uint16_t)bit;
+                        f->reportCount = (uint16_t)count;
+                        bit += count * reportSize;
+                    }
+                }
+            }
+        }
+
+        usageCount = 0;
+        haveRange = 0;
+        usageMin = usageMax = 0;
+    }
+
+    uint32_t maxBits = 8;
+    for (int r = 0; r < reportCountSeen; r++) {
+        if (reportBits[r] > maxBits)
+            maxBits = reportBits[r];
+    }
+    p->inputReportByteLength = (uint16_t)((maxBits + 7) / 8);
+    return 0;
+}
+
+static const HidShimPreparsed *shimOf(PHIDP_PREPARSED_DATA preparsed) {
+    const HidShimPreparsed *p = preparsed;
+    return p && p->magic == HIDSHIM_MAGIC ? p : NULL;
+}
+
+UINT GetRawInputDeviceInfo(HANDLE device, UINT command, LPVOID data, UINT *size) {
+    const HidShimDevice *d = device;
+    if (command != RIDI_PREPARSEDDATA || !d)
+        return (UINT)-1;
+
+    if (!data) {
+        *size = sizeof(HidShimPreparsed);
+        return 0;
+    }
+    if (*size < sizeof(HidShimPreparsed)) {
+        *size = sizeof(HidShimPreparsed);
+        return (UINT)-1;
+    }
+    memcpy(data, &d->preparsed, sizeof(HidShimPreparsed));
+    return sizeof(HidShimPreparsed);
+}
+
+NTSTATUS HidP_GetCaps(PHIDP_PREPARSED_DATA preparsed, HIDP_CAPS *caps) {
+    const HidShimPreparsed *p = shimOf(preparsed);
+    if (!p) return HIDP_STATUS_USAGE_NOT_FOUND;
+
+    memset(caps, 0, sizeof(*caps));
+    caps->UsagePage = 0x01;
+    caps->Usage = 0x05;
+    caps->InputReportByteLength = p->inputReportByteLength;
+    for (int i = 0; i < p->fieldCount; i++) {
+        if (p->fields[i].isButton)
+            caps->NumberInputButtonCaps++;
+        else
+            caps->NumberInputValueCaps++;
+    }
+    return HIDP_STATUS_SUCCESS;
+}
+
+NTSTATUS HidP_GetButtonCaps(HIDP_REPORT_TYPE type, HIDP_BUTTON_CAPS *caps, USHORT *length, PHIDP_PREPARSED_DATA preparsed) {
+    const HidShimPreparsed *p = shimOf(preparsed);
+    if (!p || type != HidP_Input) return HIDP_STATUS_USAGE_NOT_FOUND;
+
+    USHORT n = 0;
+    for (int i = 0; i < p->fieldCount; i++) {
+        const HidShimField *f = &p->fields[i];
+        if (!f->isButton) continue;
+        if (n >= *length) return HIDP_STATUS_BUFFER_TOO_SMALL;
+
+        HIDP_BUTTON_CAPS *c = &caps[n++];
+        memset(c, 0, sizeof(*c));
+        c->UsagePage = f->usagePage;
+        c->ReportID = f->reportID;
+        c->IsAbsolute = 1;
+        c->IsRange = f->isRange;
+        if (f->isRange) {
+            c->Range.UsageMin = f->usageMin;
+            c->Range.UsageMax = f->usageMax;
+        } else {
+            c->NotRange.Usage = f->usageMin;
+        }
+    }
+    *length = n;
+    return HIDP_STATUS_SUCCESS;
+}
+
+NTSTATUS HidP_GetValueCaps(HIDP_REPORT_TYPE type, HIDP_VALUE_CAPS *caps, USHORT *length, PHIDP_PREPARSED_DATA preparsed) {
+    const HidShimPreparsed *p = shimOf(preparsed);
+    if (!p || type != HidP_Input) return HIDP_STATUS_USAGE_NOT_FOUND;
+
+    USHORT n = 0;
+    for (int i = 0; i < p->fieldCount; i++) {
+        const HidShimField *f = &p->fields[i];
+        if (f->isButton) continue;
+        if (n >= *length) return HIDP_STATUS_BUFFER_TOO_SMALL;
+
+        HIDP_VALUE_CAPS *c = &caps[n++];
+        memset(c, 0, sizeof(*c));
+        c->UsagePage = f->usagePage;
+        c->ReportID = f->reportID;
+        c->IsAbsolute = 1;
+        c->IsRange = f->isRange;
+        c->BitSize = f->bitSize;
+        c->ReportCount = f->reportCount;
+        c->LogicalMin = f->logicalMin;
+        c->LogicalMax = f->logicalMax;
+        if (f->isRange) {
+            c->Range.UsageMin = f->usageMin;
+            c->Range.UsageMax = f->usageMax;
+        } else {
+            c->NotRange.Usage = f->usageMin;
+        }
+    }
+    *length = n;
+    return HIDP_STATUS_SUCCESS;
+}
+
+static uint32_t readBits(const uint8_t *report, uint32_t bit, uint32_t count) {
+    uint32_t v = 0;
+    for (uint32_t i = 0; i < count; i++, bit++)
+        v |= (uint32_t)((report[bit / 8] >> (bit % 8)) & 1) << i;
+    return v;
+}
+
+NTSTATUS HidP_GetUsageValue(HIDP_REPORT_TYPE type, USAGE usagePage, USHORT link, USAGE usage, PULONG value,
+    PHIDP_PREPARSED_DATA preparsed, PCHAR report, ULONG length) {
+    (void)link;
+    const HidShimPreparsed *p = shimOf(preparsed);
+    if (!p || type != HidP_Input) return HIDP_STATUS_USAGE_NOT_FOUND;
+    if (length < p->inputReportByteLength) return HIDP_STATUS_INVALID_REPORT_LENGTH;
+
+    const uint8_t *r = (const uint8_t *)report;
+    int sawUsage = 0;
+    for (int i = 0; i < p->fieldCount; i++) {
+        const HidShimField *f = &p->fields[i];
+        if (f->isButton || f->usagePage != usagePage || usage < f->usageMin || usage > f->usageMax)
+            continue;
+        sawUsage = 1;
+        if (f->reportID != r[0])
+            continue;
+
+        uint32_t index = f->isRange ? usage - f->usageMin : 0;
+        *value = readBits(r, f->bitOffset + index * f->bitSize, f->bitSize);
+        return HIDP_STATUS_SUCCESS;
+    }
+    return sawUsage ? HIDP_STATUS_INCOMPATIBLE_REPORT_ID : HIDP_STATUS_USAGE_NOT_FOUND;
+}
+
+NTSTATUS HidP_GetUsages(HIDP_REPORT_TYPE type, USAGE usagePage, USHORT link, PUSAGE usages, PULONG count,
+    PHIDP_PREPARSED_DATA preparsed, PCHAR report, ULONG length) {
+    (void)link;
+    const HidShimPreparsed *p = shimOf(preparsed);
+    if (!p || type != HidP_Input) return HIDP_STATUS_USAGE_NOT_FOUND;
+    if (length < p->inputReportByteLength) return HIDP_STATUS_INVALID_REPORT_LENGTH;
+
+    const uint8_t *r = (const uint8_t *)report;
+    ULONG n = 0;
+    int found = 0;
+    for (int i = 0; i < p->fieldCount; i++) {
+        const HidShimField *f = &p->fields[i];
+        if (!f->isButton || f->usagePage != usagePage || f->reportID != r[0])
+            continue;
+        found = 1;
+
+        for (uint32_t b = 0; b < f->reportCount; b++) {
+            if (!readBits(r, f->bitOffset + b, 1))
+                continue;
+            if (n >= *count) {
+                *count = n;
+                return HIDP_STATUS_BUFFER_TOO_SMALL;
+            }
+            usages[n++] = (USAGE)(f->isRange ? f->usageMin + b : f->usageMin);
+        }
+    }
+    *count = n;
+    return found ? HIDP_STATUS_SUCCESS : HIDP_STATUS_USAGE_NOT_FOUND;
+}
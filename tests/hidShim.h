@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <windows.h>
+#include <hidpi.h>
+
+/* Stand-in for hid.dll on Linux. Real preparsed data is an undocumented blob
+that only Windows can produce, so instead a device is described by its HID
+report descriptor, which is parsed here into a small table of input fields.
+The HidP calls the tool uses answer from that table following the Windows
+rules (one cap per listed usage, 1-bit fields are buttons, the report ID
+byte is always there and 0 when the device has none). */
+
+#define HIDSHIM_MAX_FIELDS 32
+
+typedef struct {
+    uint8_t reportID;
+    uint8_t isButton;
+    uint8_t isRange;
+    uint16_t usagePage;
+    uint16_t usageMin;
+    uint16_t usageMax;
+    uint16_t bitOffset;     // from the start of the report, including the ID byte
+    uint16_t bitSize;
+    uint16_t reportCount;
+    int32_t logicalMin;
+    int32_t logicalMax;
+} HidShimField;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t inputReportByteLength;
+    uint16_t fieldCount;
+    HidShimField fields[HIDSHIM_MAX_FIELDS];
+} HidShimPreparsed;
+
+// What GetRawInputDeviceInfo sees as a device handle
+typedef struct {
+    HidShimPreparsed preparsed;
+} HidShimDevice;
+
+// Returns 0 on success, -1 if the descriptor uses something the shim doesn't model
+int hidshim_build(HidShimDevice *device, const uint8_t *descriptor, size_t length);
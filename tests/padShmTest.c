@@ -0,0 +1,164 @@
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <padShm.h>
+#include "check.h"
+
+/* Writer and reader against a real POSIX segment: round trip, torn reads
+under a concurrent writer, and segments the reader has to refuse. */
+
+#define TORN_ITERATIONS 200000
+
+static char segName[64];
+static volatile int writerDone = 0;
+
+static void fillState(GamepadState *g, uint32_t v) {
+    memset(g, 0, sizeof(*g));
+    g->connected = 1;
+    g->buttons = v;
+    for (int a = 0; a < INPUT_AXIS_COUNT; a++)
+        g->axes[a] = (float)v;
+    g->sensors.gyro[0] = (int16_t)v;
+}
+
+static int consistent(const GamepadState *g) {
+    for (int a = 0; a < INPUT_AXIS_COUNT; a++) {
+        if (g->axes[a] != (float)g->buttons)
+            return 0;
+    }
+    return g->sensors.gyro[0] == (int16_t)g->buttons;
+}
+
+static void testRoundTrip(void) {
+    CHECK(padshm_publish_open(segName, 4) == 0);
+
+    GamepadState g;
+    fillState(&g, 42);
+    padshm_publish(1, &g);
+
+    PadShmReader *reader = padshm_open(segName);
+    CHECK(reader != NULL);
+    if (!reader) return;
+
+    CHECK(padshm_slot_count(reader) == 4);
+
+    PadShmSnapshot snap;
+    CHECK(padshm_read(reader, 1, &snap) == 1);
+    CHECK(snap.sequence == 1);
+    CHECK(snap.timestampUs > 0);
+    CHECK(snap.state.buttons == 42 && consistent(&snap.state));
+
+    CHECK(padshm_read(reader, 0, &snap) == 1);
+    CHECK(snap.sequence == 0 && snap.state.connected == 0);
+    CHECK(padshm_read(reader, 4, &snap) == 0);
+    CHECK(padshm_read(reader, -1, &snap) == 0);
+
+    // NULL publishes a disconnected pad
+    padshm_publish(1, NULL);
+    CHECK(padshm_read(reader, 1, &snap) == 1);
+    CHECK(snap.sequence == 2 && snap.state.connected == 0);
+
+    padshm_close(reader);
+}
+
+static void *writerThread(void *arg) {
+    (void)arg;
+    GamepadState g;
+    for (uint32_t v = 1; v <= TORN_ITERATIONS; v++) {
+        fillState(&g, v);
+        padshm_publish(0, &g);
+    }
+    __atomic_store_n(&writerDone, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void testNoTornReads(void) {
+    PadShmReader *reader = padshm_open(segName);
+    CHECK(reader != NULL);
+    if (!reader) return;
+
+    pthread_t writer;
+    pthread_create(&writer, NULL, writerThread, NULL);
+
+    int torn = 0, reads = 0;
+    uint64_t lastSequence = 0;
+    while (!__atomic_load_n(&writerDone, __ATOMIC_ACQUIRE)) {
+        PadShmSnapshot snap;
+        if (!padshm_read(reader, 0, &snap))
+            continue;
+        reads++;
+        if (!consistent(&snap.state) || snap.sequence < lastSequence)
+            torn++;
+        lastSequence = snap.sequence;
+    }
+    pthread_join(writer, NULL);
+
+    CHECK(torn == 0);
+    CHECK(reads > 0);
+    padshm_close(reader);
+    padshm_publish_close();
+}
+
+// Hand-made segment: a valid header on top of a mapping of the given size
+static void makeSegment(const char *name, uint32_t magic, uint32_t slotCount, size_t size) {
+    char path[96];
+    snprintf(path, sizeof(path), "/%s", name);
+    int fd = shm_open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0 || ftruncate(fd, (off_t)size) != 0) {
+        CHECK(!"could not create test segment");
+        if (fd >= 0) close(fd);
+        return;
+    }
+
+    PadShmHeader h = { magic, PADSHM_VERSION, slotCount, sizeof(PadShmSlot) };
+    size_t n = sizeof(h) < size ? sizeof(h) : size;
+    CHECK(pwrite(fd, &h, n, 0) == (ssize_t)n);
+    close(fd);
+}
+
+static void dropSegment(const char *name) {
+    char path[96];
+    snprintf(path, sizeof(path), "/%s", name);
+    shm_unlink(path);
+}
+
+static void testRejectsBadSegments(void) {
+    char name[80];
+    snprintf(name, sizeof(name), "%s_bad", segName);
+
+    CHECK(padshm_open(name) == NULL);   // doesn't exist
+
+    // Header claims 1000 slots, only one is backed
+    makeSegment(name, PADSHM_MAGIC, 1000, sizeof(PadShmHeader) + sizeof(PadShmSlot));
+    CHECK(padshm_open(name) == NULL);
+
+    // Slot count that would overflow 32 bits when multiplied
+    makeSegment(name, PADSHM_MAGIC, 0xFFFFFFFFu, sizeof(PadShmHeader) + sizeof(PadShmSlot));
+    CHECK(padshm_open(name) == NULL);
+
+    // Shorter than the header itself
+    makeSegment(name, PADSHM_MAGIC, 0, 8);
+    CHECK(padshm_open(name) == NULL);
+
+    makeSegment(name, 0x12345678u, 1, sizeof(PadShmHeader) + sizeof(PadShmSlot));
+    CHECK(padshm_open(name) == NULL);
+
+    // Exactly big enough is fine
+    makeSegment(name, PADSHM_MAGIC, 2, sizeof(PadShmHeader) + 2 * sizeof(PadShmSlot));
+    PadShmReader *reader = padshm_open(name);
+    CHECK(reader != NULL && padshm_slot_count(reader) == 2);
+    padshm_close(reader);
+
+    dropSegment(name);
+}
+
+int main(void) {
+    snprintf(segName, sizeof(segName), "cdebug_test_%d", (int)getpid());
+
+    testRoundTrip();
+    testNoTornReads();
+    testRejectsBadSegments();
+    return checkReport("padShmTest");
+}
@@ -0,0 +1,143 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <soak.h>
+#include "check.h"
+
+/* Soak accumulators: slot reuse, reconnect gaps and a report written while
+another thread keeps sampling. Times are fed in directly, so nothing here
+depends on how fast the machine is. */
+
+static char reportPath[] = "/tmp/soakTestXXXXXX";
+
+static char *writeReport(void) {
+    CHECK(soak_write_report(reportPath) == 0);
+
+    static char text[64 * 1024];
+    FILE *fp = fopen(reportPath, "r");
+    size_t n = fp ? fread(text, 1, sizeof(text) - 1, fp) : 0;
+    text[n] = '\0';
+    if (fp) fclose(fp);
+    return text;
+}
+
+// Numbers for one source in the report, -1 if the source isn't there
+static long long sourceField(const char *text, const char *header, const char *field) {
+    const char *at = strstr(text, header);
+    if (!at) return -1;
+    const char *end = strstr(at + 1, "\n[");
+    const char *f = strstr(at, field);
+    if (!f || (end && f > end)) return -1;
+    return atoll(f + strlen(field));
+}
+
+static void testIdlePad(void) {
+    soak_enable();
+    GamepadState g;
+    memset(&g, 0, sizeof(g));
+
+    // An idle pad polled at 1 kHz for 10 s has no gaps
+    soak_connect(SOAK_SOURCE_XINPUT(0), 0x045E, 0x028E);
+    for (uint64_t t = 0; t < 10000; t++)
+        soak_sample(SOAK_SOURCE_XINPUT(0), &g, 1000000 + t * 1000);
+
+    const char *text = writeReport();
+    CHECK(sourceField(text, "[xinput 0] 045E:028E", "samples ") == 10000);
+    CHECK(sourceField(text, "[xinput 0]", "gaps > 50 ms: ") == 0);
+}
+
+static void testSlotReuse(void) {
+    soak_enable();
+    GamepadState g;
+    memset(&g, 0, sizeof(g));
+    int src = SOAK_SOURCE_RAW(3);
+
+    soak_connect(src, 0x054C, 0x05C4);
+    for (uint64_t t = 0; t < 100; t++)
+        soak_sample(src, &g, t * 4000);
+    soak_disconnect(src);
+
+    // Same pad back after 5 s: keeps its stats, the outage is a disconnect and not a gap
+    soak_connect(src, 0x054C, 0x05C4);
+    for (uint64_t t = 0; t < 100; t++)
+        soak_sample(src, &g, 5000000 + t * 4000);
+
+    const char *text = writeReport();
+    CHECK(sourceField(text, "[raw 3] 054C:05C4", "samples ") == 200);
+    CHECK(sourceField(text, "[raw 3]", "gaps > 50 ms: ") == 0);
+    CHECK(sourceField(text, "[raw 3]", "disconnects: ") == 1);
+    CHECK(strstr(text, "slot reused") == NULL);
+
+    // Another pad in the same slot starts over
+    soak_disconnect(src);
+    soak_connect(src, 0x054C, 0x0CDA);
+    for (uint64_t t = 0; t < 10; t++)
+        soak_sample(src, &g, 9000000 + t * 4000);
+
+    text = writeReport();
+    CHECK(sourceField(text, "[raw 3] 054C:0CDA", "samples ") == 10);
+    CHECK(sourceField(text, "[raw 3]", "disconnects: ") == 0);
+    CHECK(strstr(text, "1 earlier device(s) not included") != NULL);
+    CHECK(strstr(text, "05C4") == NULL);
+}
+
+// Writer thread: LX is the sample index, so a consistent copy has mean (n-1)/2 and max n-1
+static volatile int writerDone = 0;
+
+static void *writerThread(void *arg) {
+    (void)arg;
+    GamepadState g;
+    memset(&g, 0, sizeof(g));
+
+    for (int k = 0; k < 400000; k++) {
+        g.axes[INPUT_AXIS_LEFT_X] = (float)(k % 1000000);
+        g.buttons = k & 1;
+        soak_sample(SOAK_SOURCE_RAW(0), &g, (uint64_t)k * 1000);
+    }
+    writerDone = 1;
+    return NULL;
+}
+
+static void testConcurrentReport(void) {
+    soak_enable();
+    soak_connect(SOAK_SOURCE_RAW(0), 0x054C, 0x09CC);
+
+    pthread_t writer;
+    pthread_create(&writer, NULL, writerThread, NULL);
+
+    int reports = 0, torn = 0;
+    while (!writerDone || reports == 0) {
+        const char *text = writeReport();
+        reports++;
+
+        long long n = sourceField(text, "[raw 0]", "samples ");
+        if (n <= 0) continue;
+
+        const char *lx = strstr(text, "  LX ");
+        double mean = 0, stddev = 0, min = 0, max = 0;
+        if (!lx || sscanf(lx + 5, "%lf %lf %lf %lf", &mean, &stddev, &min, &max) != 4) {
+            torn++;
+            continue;
+        }
+        if (mean != (double)(n - 1) / 2 || max != (double)(n - 1))
+            torn++;
+    }
+    pthread_join(writer, NULL);
+
+    CHECK(reports > 0);
+    CHECK(torn == 0);
+}
+
+int main(void) {
+    int fd = mkstemp(reportPath);
+    CHECK(fd >= 0);
+    close(fd);
+
+    testIdlePad();
+    testSlotReuse();
+    testConcurrentReport();
+
+    unlink(reportPath);
+    return checkReport("soakTest");
+}
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <trace.h>
+#include <timing.h>
+
+/* Cost of one TRACE_SCOPE, begin and end together, with the ring already
+allocated. The request budget is well under a microsecond per event. Also
+runs the empty loop so the overhead can be told apart from the loop itself. */
+
+#define BENCH_EVENTS 10000000
+
+static void __attribute__((noinline)) emptyStage(volatile int *sink, int i) {
+    *sink += i;
+}
+
+static void __attribute__((noinline)) tracedStage(volatile int *sink, int i) {
+    TRACE_SCOPE("stage");
+    *sink += i;
+}
+
+int main(void) {
+    volatile int sink = 0;
+
+    // First event allocates the thread's buffer, keep that out of the timing
+    tracedStage(&sink, 0);
+
+    uint64_t start = timing_ticks();
+    for (int i = 0; i < BENCH_EVENTS; i++)
+        emptyStage(&sink, i);
+    uint64_t empty = timing_ticks() - start;
+
+    start = timing_ticks();
+    for (int i = 0; i < BENCH_EVENTS; i++)
+        tracedStage(&sink, i);
+    uint64_t traced = timing_ticks() - start;
+
+    double nsEmpty = (double)empty * 1e9 / timing_ticks_per_sec() / BENCH_EVENTS;
+    double nsTraced = (double)traced * 1e9 / timing_ticks_per_sec() / BENCH_EVENTS;
+    printf("trace: %d scopes, %.1f ns/event (%.1f ns with the empty loop taken out)\n",
+        BENCH_EVENTS, nsTraced, nsTraced - nsEmpty);
+    return 0;
+}
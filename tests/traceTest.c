@@ -0,0 +1,264 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <trace.h>
+#include "check.h"
+
+/* Trace export from two threads recording nested scopes. The output has to
+parse as JSON, every "ts" has to be rebased to a small non-negative offset, and
+inner scopes have to sit inside the scope that encloses them. Built with a
+small TRACE_BUFFER_EVENTS so the ring wraps and the oldest events are dropped. */
+
+#define TEST_FRAMES 1000
+#define TEST_MAX_EVENTS (2 * TRACE_BUFFER_EVENTS + 16)
+
+typedef struct {
+    char name[32];
+    char ph[4];
+    int tid;
+    double ts;
+    double dur;
+} ParsedEvent;
+
+static ParsedEvent parsed[TEST_MAX_EVENTS];
+static int parsedCount = 0;
+
+// Small recursive JSON checker. Objects inside "traceEvents" are also copied into parsed[]
+typedef struct {
+    const char *p;
+    int depth;
+    int ok;
+} Json;
+
+static int parseValue(Json *j, ParsedEvent *ev, const char *key);
+
+static void skipSpace(Json *j) {
+    while (*j->p == ' ' || *j->p == '\n' || *j->p == '\r' || *j->p == '\t')
+        j->p++;
+}
+
+static int parseString(Json *j, char *out, size_t outSize) {
+    if (*j->p != '"') return 0;
+    j->p++;
+    size_t n = 0;
+    while (*j->p && *j->p != '"') {
+        if ((unsigned char)*j->p < 0x20) return 0;
+        if (*j->p == '\\') {
+            j->p++;
+            if (!*j->p) return 0;
+        }
+        if (out && n + 1 < outSize) out[n++] = *j->p;
+        j->p++;
+    }
+    if (*j->p != '"') return 0;
+    if (out) out[n] = '\0';
+    j->p++;
+    return 1;
+}
+
+static int parseNumber(Json *j, double *out) {
+    char *end;
+    double v = strtod(j->p, &end);
+    if (end == j->p) return 0;
+    if (out) *out = v;
+    j->p = end;
+    return 1;
+}
+
+static int parseObject(Json *j, ParsedEvent *ev) {
+    j->p++;
+    skipSpace(j);
+    if (*j->p == '}') { j->p++; return 1; }
+
+    for (;;) {
+        char key[32];
+        skipSpace(j);
+        if (!parseString(j, key, sizeof(key))) return 0;
+        skipSpace(j);
+        if (*j->p != ':') return 0;
+        j->p++;
+        skipSpace(j);
+        if (!parseValue(j, ev, key)) return 0;
+        skipSpace(j);
+        if (*j->p == ',') { j->p++; continue; }
+        if (*j->p == '}') { j->p++; return 1; }
+        return 0;
+    }
+}
+
+static int parseArray(Json *j, const char *key) {
+    j->p++;
+    skipSpace(j);
+    if (*j->p == ']') { j->p++; return 1; }
+
+    int events = key && j->depth == 2 && strcmp(key, "traceEvents") == 0;
+    for (;;) {
+        skipSpace(j);
+        ParsedEvent *ev = NULL;
+        if (events && *j->p == '{') {
+            if (parsedCount >= TEST_MAX_EVENTS) return 0;
+            ev = &parsed[parsedCount++];
+            memset(ev, 0, sizeof(*ev));
+            ev->ts = ev->dur = -1;
+        }
+        if (!parseValue(j, ev, NULL)) return 0;
+        skipSpace(j);
+        if (*j->p == ',') { j->p++; continue; }
+        if (*j->p == ']') { j->p++; return 1; }
+        return 0;
+    }
+}
+
+static int parseValue(Json *j, ParsedEvent *ev, const char *key) {
+    skipSpace(j);
+    int ok;
+    j->depth++;
+    if (*j->p == '{') {
+        // Only the event object itself fills ev, not its "args"
+        ok = parseObject(j, key ? NULL : ev);
+    } else if (*j->p == '[') {
+        ok = parseArray(j, key);
+    } else if (*j->p == '"') {
+        char *out = NULL;
+        size_t outSize = 0;
+        if (ev && key && strcmp(key, "name") == 0) { out = ev->name; outSize = sizeof(ev->name); }
+        if (ev && key && strcmp(key, "ph") == 0) { out = ev->ph; outSize = sizeof(ev->ph); }
+        ok = parseString(j, out, outSize);
+    } else if (strncmp(j->p, "true", 4) == 0 || strncmp(j->p, "null", 4) == 0) {
+        j->p += 4;
+        ok = 1;
+    } else if (strncmp(j->p, "false", 5) == 0) {
+        j->p += 5;
+        ok = 1;
+    } else {
+        double v;
+        ok = parseNumber(j, &v);
+        if (ok && ev && key) {
+            if (strcmp(key, "tid") == 0) ev->tid = (int)v;
+            if (strcmp(key, "ts") == 0) ev->ts = v;
+            if (strcmp(key, "dur") == 0) ev->dur = v;
+        }
+    }
+    j->depth--;
+    return ok;
+}
+
+static int parseTrace(const char *text) {
+    Json j = { text, 0, 1 };
+    parsedCount = 0;
+    if (!parseValue(&j, NULL, NULL)) return 0;
+    skipSpace(&j);
+    return *j.p == '\0';
+}
+
+// A short busy wait so nested scopes have a measurable length
+static void spin(int n) {
+    volatile int sink = 0;
+    for (int i = 0; i < n; i++)
+        sink += i;
+}
+
+// The whole run is one more scope around the frames, like rawUpdate around parseReport
+static void recordFrames(void) {
+    TRACE_SCOPE("run");
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        TRACE_SCOPE("frame");
+        {
+            TRACE_SCOPE("decode");
+            spin(200);
+        }
+        {
+            TRACE_SCOPE("publish");
+            spin(100);
+        }
+    }
+}
+
+static void *workerMain(void *arg) {
+    (void)arg;
+    TRACE_THREAD_NAME("worker");
+    recordFrames();
+    return NULL;
+}
+
+// Inner scopes are written before the frame that holds them, check each frame against the two before it
+static void checkThread(int tid) {
+    int events = 0, frames = 0;
+    double lastFrameTs = -1;
+
+    for (int i = 0; i < parsedCount; i++) {
+        const ParsedEvent *ev = &parsed[i];
+        if (ev->tid != tid || strcmp(ev->ph, "X") != 0) continue;
+        events++;
+        if (strcmp(ev->name, "frame") != 0) continue;
+        frames++;
+
+        CHECK(ev->ts > lastFrameTs);
+        lastFrameTs = ev->ts;
+
+        if (i < 2) continue;
+        const ParsedEvent *decode = &parsed[i - 2], *publish = &parsed[i - 1];
+        if (decode->tid != tid || strcmp(decode->name, "decode") != 0) continue;
+        CHECK(strcmp(publish->name, "publish") == 0);
+
+        // %.3f rounding can move either edge by half a nanosecond
+        const double slack = 0.002;
+        CHECK(decode->ts >= ev->ts - slack);
+        CHECK(publish->ts >= decode->ts + decode->dur - slack);
+        CHECK(publish->ts + publish->dur <= ev->ts + ev->dur + slack);
+    }
+
+    // The ring keeps exactly the newest TRACE_BUFFER_EVENTS
+    CHECK(events == TRACE_BUFFER_EVENTS);
+    CHECK(frames >= TRACE_BUFFER_EVENTS / 3);
+}
+
+int main(void) {
+    char path[] = "/tmp/traceTestXXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    if (fd >= 0) close(fd);
+
+    TRACE_THREAD_NAME("main");
+    pthread_t worker;
+    pthread_create(&worker, NULL, workerMain, NULL);
+    recordFrames();
+    pthread_join(worker, NULL);
+
+    CHECK(trace_export(path) == 0);
+
+    static char text[4 * 1024 * 1024];
+    FILE *fp = fopen(path, "r");
+    size_t n = fp ? fread(text, 1, sizeof(text) - 1, fp) : 0;
+    text[n] = '\0';
+    if (fp) fclose(fp);
+    unlink(path);
+
+    CHECK(n > 0 && n < sizeof(text) - 1);
+    CHECK(parseTrace(text));
+
+    int names = 0;
+    double minTs = 1e300;
+    for (int i = 0; i < parsedCount; i++) {
+        const ParsedEvent *ev = &parsed[i];
+        if (strcmp(ev->ph, "M") == 0) {
+            names++;
+            continue;
+        }
+        CHECK(strcmp(ev->ph, "X") == 0);
+        CHECK(ev->tid == 1 || ev->tid == 2);
+
+        // A start before the base used to wrap around to ~1.8e13 us
+        CHECK(ev->ts >= 0 && ev->ts < 60e6);
+        CHECK(ev->dur >= 0 && ev->dur < 60e6);
+        if (ev->ts < minTs) minTs = ev->ts;
+    }
+    CHECK(names == 2);
+    CHECK(minTs == 0);
+
+    checkThread(1);
+    checkThread(2);
+
+    return checkReport("traceTest");
+}
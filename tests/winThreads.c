@@ -0,0 +1,144 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <windows.h>
+
+/* Win32 events and threads on top of pthreads, for running the decode pool
+on Linux. Only the parts decodePool.c uses: auto and manual reset events,
+waiting on an event or for a thread to exit, and CloseHandle on either. */
+
+typedef enum {
+    OBJECT_EVENT,
+    OBJECT_THREAD
+} ObjectKind;
+
+typedef struct {
+    ObjectKind kind;
+
+    // Event
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int signaled;
+    int manualReset;
+
+    // Thread
+    pthread_t thread;
+    LPTHREAD_START_ROUTINE start;
+    LPVOID param;
+    int joined;
+} WinObject;
+
+HANDLE CreateEvent(void *attributes, BOOL manualReset, BOOL initialState, LPCSTR name) {
+    (void)attributes;
+    (void)name;
+
+    WinObject *e = calloc(1, sizeof(WinObject));
+    if (!e) return NULL;
+    e->kind = OBJECT_EVENT;
+    e->manualReset = manualReset;
+    e->signaled = initialState;
+    pthread_mutex_init(&e->mutex, NULL);
+    pthread_cond_init(&e->cond, NULL);
+    return e;
+}
+
+BOOL SetEvent(HANDLE event) {
+    WinObject *e = event;
+    pthread_mutex_lock(&e->mutex);
+    e->signaled = 1;
+    if (e->manualReset)
+        pthread_cond_broadcast(&e->cond);
+    else
+        pthread_cond_signal(&e->cond);
+    pthread_mutex_unlock(&e->mutex);
+    return TRUE;
+}
+
+static void *threadMain(void *param) {
+    WinObject *t = param;
+    t->start(t->param);
+    return NULL;
+}
+
+HANDLE CreateThread(void *attributes, size_t stackSize, LPTHREAD_START_ROUTINE start, LPVOID param,
+    DWORD flags, DWORD *threadId) {
+    (void)attributes;
+    (void)stackSize;
+    (void)flags;
+
+    WinObject *t = calloc(1, sizeof(WinObject));
+    if (!t) return NULL;
+    t->kind = OBJECT_THREAD;
+    t->start = start;
+    t->param = param;
+    if (pthread_create(&t->thread, NULL, threadMain, t) != 0) {
+        free(t);
+        return NULL;
+    }
+    if (threadId)
+        *threadId = 0;
+    return t;
+}
+
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds) {
+    WinObject *o = handle;
+
+    if (o->kind == OBJECT_THREAD) {
+        if (!o->joined) {
+            pthread_join(o->thread, NULL);
+            o->joined = 1;
+        }
+        return WAIT_OBJECT_0;
+    }
+
+    struct timespec deadline;
+    if (milliseconds != INFINITE) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += milliseconds / 1000;
+        deadline.tv_nsec += (long)(milliseconds % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
+
+    DWORD result = WAIT_OBJECT_0;
+    pthread_mutex_lock(&o->mutex);
+    while (!o->signaled) {
+        if (milliseconds == INFINITE) {
+            pthread_cond_wait(&o->cond, &o->mutex);
+        } else if (pthread_cond_timedwait(&o->cond, &o->mutex, &deadline) == ETIMEDOUT) {
+            result = WAIT_TIMEOUT;
+            break;
+        }
+    }
+    if (result == WAIT_OBJECT_0 && !o->manualReset)
+        o->signaled = 0;
+    pthread_mutex_unlock(&o->mutex);
+    return result;
+}
+
+BOOL CloseHandle(HANDLE handle) {
+    WinObject *o = handle;
+    if (!o) return FALSE;
+
+    if (o->kind == OBJECT_THREAD) {
+        if (!o->joined)
+            pthread_detach(o->thread);
+    } else {
+        pthread_mutex_destroy(&o->mutex);
+        pthread_cond_destroy(&o->cond);
+    }
+    free(o);
+    return TRUE;
+}
+
+DWORD GetLastError(void) {
+    return (DWORD)errno;
+}
+
+void Sleep(DWORD milliseconds) {
+    struct timespec ts = { milliseconds / 1000, (long)(milliseconds % 1000) * 1000000 };
+    nanosleep(&ts, NULL);
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <windows.h>
+
+// HidP types and calls used by the decoder, field layout as in the Windows SDK
+
+typedef void *PHIDP_PREPARSED_DATA;
+
+typedef enum {
+    HidP_Input,
+    HidP_Output,
+    HidP_Feature
+} HIDP_REPORT_TYPE;
+
+typedef struct {
+    USAGE Usage;
+    USAGE UsagePage;
+    USHORT InputReportByteLength;
+    USHORT OutputReportByteLength;
+    USHORT FeatureReportByteLength;
+    USHORT Reserved[17];
+    USHORT NumberLinkCollectionNodes;
+    USHORT NumberInputButtonCaps;
+    USHORT NumberInputValueCaps;
+    USHORT NumberInputDataIndices;
+    USHORT NumberOutputButtonCaps;
+    USHORT NumberOutputValueCaps;
+    USHORT NumberOutputDataIndices;
+    USHORT NumberFeatureButtonCaps;
+    USHORT NumberFeatureValueCaps;
+    USHORT NumberFeatureDataIndices;
+} HIDP_CAPS;
+
+typedef struct {
+    USAGE UsageMin, UsageMax;
+    USHORT StringMin, StringMax;
+    USHORT DesignatorMin, DesignatorMax;
+    USHORT DataIndexMin, DataIndexMax;
+} HidpRange;
+
+typedef struct {
+    USAGE Usage, Reserved1;
+    USHORT StringIndex, Reserved2;
+    USHORT DesignatorIndex, Reserved3;
+    USHORT DataIndex, Reserved4;
+} HidpNotRange;
+
+typedef struct {
+    USAGE UsagePage;
+    UCHAR ReportID;
+    BOOLEAN IsAlias;
+    USHORT BitField;
+    USHORT LinkCollection;
+    USAGE LinkUsage;
+    USAGE LinkUsagePage;
+    BOOLEAN IsRange;
+    BOOLEAN IsStringRange;
+    BOOLEAN IsDesignatorRange;
+    BOOLEAN IsAbsolute;
+    ULONG Reserved[10];
+    union {
+        HidpRange Range;
+        HidpNotRange NotRange;
+    };
+} HIDP_BUTTON_CAPS;
+
+typedef struct {
+    USAGE UsagePage;
+    UCHAR ReportID;
+    BOOLEAN IsAlias;
+    USHORT BitField;
+    USHORT LinkCollection;
+    USAGE LinkUsage;
+    USAGE LinkUsagePage;
+    BOOLEAN IsRange;
+    BOOLEAN IsStringRange;
+    BOOLEAN IsDesignatorRange;
+    BOOLEAN IsAbsolute;
+    BOOLEAN HasNull;
+    UCHAR Reserved;
+    USHORT BitSize;
+    USHORT ReportCount;
+    USHORT Reserved2[5];
+    ULONG UnitsExp;
+    ULONG Units;
+    LONG LogicalMin, LogicalMax;
+    LONG PhysicalMin, PhysicalMax;
+    union {
+        HidpRange Range;
+        HidpNotRange NotRange;
+    };
+} HIDP_VALUE_CAPS;
+
+#define HIDP_STATUS_SUCCESS              ((NTSTATUS)0x00110000)
+#define HIDP_STATUS_INVALID_REPORT_LENGTH ((NTSTATUS)0xC0110003)
+#define HIDP_STATUS_USAGE_NOT_FOUND      ((NTSTATUS)0xC0110004)
+#define HIDP_STATUS_BUFFER_TOO_SMALL     ((NTSTATUS)0xC0110007)
+#define HIDP_STATUS_INCOMPATIBLE_REPORT_ID ((NTSTATUS)0xC011000A)
+
+#define HID_USAGE_PAGE_BUTTON 0x09
+
+NTSTATUS HidP_GetCaps(PHIDP_PREPARSED_DATA preparsed, HIDP_CAPS *caps);
+NTSTATUS HidP_GetButtonCaps(HIDP_REPORT_TYPE type, HIDP_BUTTON_CAPS *caps, USHORT *length, PHIDP_PREPARSED_DATA preparsed);
+NTSTATUS HidP_GetValueCaps(HIDP_REPORT_TYPE type, HIDP_VALUE_CAPS *caps, USHORT *length, PHIDP_PREPARSED_DATA preparsed);
+NTSTATUS HidP_GetUsageValue(HIDP_REPORT_TYPE type, USAGE usagePage, USHORT link, USAGE usage, PULONG value,
+    PHIDP_PREPARSED_DATA preparsed, PCHAR report, ULONG length);
+NTSTATUS HidP_GetUsages(HIDP_REPORT_TYPE type, USAGE usagePage, USHORT link, PUSAGE usages, PULONG count,
+    PHIDP_PREPARSED_DATA preparsed, PCHAR report, ULONG length);
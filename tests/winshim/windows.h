@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/* Just enough of windows.h for the HID layout and decode sources to build on
+Linux. The HID functions declared here are implemented by tests/hidShim.c,
+the thread and event ones by tests/winThreads.c. */
+
+typedef uint8_t BYTE;
+typedef char CHAR, *PCHAR;
+typedef uint8_t UCHAR, BOOLEAN;
+typedef uint16_t USHORT, WORD, USAGE, *PUSAGE;
+typedef int32_t LONG, NTSTATUS, BOOL;
+typedef uint32_t ULONG, *PULONG, UINT;
+typedef unsigned long DWORD;     // only for format strings, nothing here depends on its size
+typedef void *HANDLE, *LPVOID;
+typedef const char *LPCSTR;
+
+#define WINAPI
+#define TRUE 1
+#define FALSE 0
+#define INFINITE 0xFFFFFFFF
+#define WAIT_OBJECT_0 0
+#define WAIT_TIMEOUT 0x102
+
+#define RIDI_PREPARSEDDATA 0x20000005
+
+UINT GetRawInputDeviceInfo(HANDLE device, UINT command, LPVOID data, UINT *size);
+
+typedef DWORD (WINAPI *LPTHREAD_START_ROUTINE)(LPVOID param);
+
+HANDLE CreateEvent(void *attributes, BOOL manualReset, BOOL initialState, LPCSTR name);
+BOOL SetEvent(HANDLE event);
+HANDLE CreateThread(void *attributes, size_t stackSize, LPTHREAD_START_ROUTINE start, LPVOID param,
+    DWORD flags, DWORD *threadId);
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds);
+BOOL CloseHandle(HANDLE handle);
+DWORD GetLastError(void);
+void Sleep(DWORD milliseconds);
+
+static inline void YieldProcessor(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
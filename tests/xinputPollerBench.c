@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <string.h>
+#include <xinputPoller.h>
+#include <timing.h>
+
+/* XInput schedule over a simulated minute at 1 kHz: one pad whose packet moves
+on a fifth of the frames and three empty slots. Counts what the main loop and
+the probe thread each ask XInputGetState for, next to what the old
+read-everything loop did, then times the scheduler itself with a free
+getState. */
+
+#define BENCH_FRAMES 60000          // 60 s at 1 kHz
+#define BENCH_FRAME_US 1000
+#define BENCH_TIMED_FRAMES 5000000
+
+static int probing;
+static uint64_t mainCalls, mainEmptyCalls, probeCalls;
+static uint32_t packet;
+
+static uint32_t fakeGetState(uint32_t slot, XPollRawState *out) {
+    if (probing)
+        probeCalls++;
+    else
+        mainCalls++;
+
+    if (slot != 0) {
+        if (!probing)
+            mainEmptyCalls++;
+        return 1167;    // ERROR_DEVICE_NOT_CONNECTED
+    }
+    memset(out, 0, sizeof(*out));
+    out->packetNumber = packet;
+    return 0;
+}
+
+static uint32_t freeGetState(uint32_t slot, XPollRawState *out) {
+    out->packetNumber = packet;
+    return slot == 0 ? 0 : 1167;
+}
+
+int main(void) {
+    XPoller p;
+    XPollRawState state;
+    xpoll_init(&p, fakeGetState);
+
+    uint32_t seed = 1;
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        uint64_t now = (uint64_t)f * BENCH_FRAME_US;
+        if (now % XPOLL_PROBE_INTERVAL_US == 0) {
+            probing = 1;
+            xpoll_probe(&p, now);
+            probing = 0;
+        }
+
+        seed = seed * 1664525u + 1013904223u;
+        if ((seed >> 16) % 5 == 0)
+            packet++;
+
+        xpoll_begin(&p, now);
+        for (int i = 0; i < XPOLL_MAX_SLOTS; i++)
+            xpoll_slot(&p, i, &state);
+    }
+
+    printf("xinput poller: %d frames, 1 pad + %d empty slots\n", BENCH_FRAMES, XPOLL_MAX_SLOTS - 1);
+    printf("  old loop     main: %.2f calls/frame, %.2f empty-slot calls/frame, 1.00 decodes/frame\n",
+        (double)XPOLL_MAX_SLOTS, (double)(XPOLL_MAX_SLOTS - 1));
+    printf("  scheduler    main: %.2f calls/frame, %.2f empty-slot calls/frame, %.2f decodes/frame\n",
+        (double)mainCalls / BENCH_FRAMES, (double)mainEmptyCalls / BENCH_FRAMES, (double)p.decodes / BENCH_FRAMES);
+    printf("               probe thread: %llu calls, %.2f/s once backed off\n",
+        (unsigned long long)probeCalls, (double)(XPOLL_MAX_SLOTS - 1) * 1e6 / XPOLL_BACKOFF_MAX_US);
+
+    // Scheduler overhead per update, getState costs nothing here
+    xpoll_init(&p, freeGetState);
+    xpoll_probe(&p, 0);
+    uint64_t start = timing_ticks();
+    for (int f = 0; f < BENCH_TIMED_FRAMES; f++) {
+        packet += f & 1;
+        xpoll_begin(&p, (uint64_t)f * BENCH_FRAME_US);
+        for (int i = 0; i < XPOLL_MAX_SLOTS; i++)
+            xpoll_slot(&p, i, &state);
+    }
+    double ns = timing_ticks_to_us(timing_ticks() - start) * 1000.0 / BENCH_TIMED_FRAMES;
+    printf("  scheduler overhead: %.1f ns per update of %d slots\n", ns, XPOLL_MAX_SLOTS);
+    return 0;
+}
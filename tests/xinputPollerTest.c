@@ -0,0 +1,234 @@
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <xinputPoller.h>
+#include "check.h"
+
+/* XInput scheduling against a fake XInputGetState. Time is fed in by hand, so
+the backoff can be checked exactly. The last test runs the probe on a second
+thread while pads come and go and checks the update and the probe never
+query the same slot at once. */
+
+typedef struct {
+    int present;
+    uint32_t packet;
+    XPollRawState state;
+} FakePad;
+
+static FakePad pads[XPOLL_MAX_SLOTS];
+static int probing;                             // set while xpoll_probe runs
+static int updateCalls[XPOLL_MAX_SLOTS];
+static int probeCalls[XPOLL_MAX_SLOTS];
+static int emptyReadsOnUpdate;
+static int inFlight[XPOLL_MAX_SLOTS];
+static int overlaps;
+static int widenCalls;                          // yield inside getState so the threads interleave
+
+static uint32_t fakeGetState(uint32_t slot, XPollRawState *out) {
+    if (__atomic_add_fetch(&inFlight[slot], 1, __ATOMIC_SEQ_CST) != 1)
+        __atomic_add_fetch(&overlaps, 1, __ATOMIC_RELAXED);
+
+    if (widenCalls)
+        sched_yield();
+
+    if (probing)
+        probeCalls[slot]++;
+    else
+        updateCalls[slot]++;
+
+    uint32_t result = 1167;    // ERROR_DEVICE_NOT_CONNECTED
+    if (__atomic_load_n(&pads[slot].present, __ATOMIC_ACQUIRE)) {
+        *out = pads[slot].state;
+        out->packetNumber = __atomic_load_n(&pads[slot].packet, __ATOMIC_RELAXED);
+        result = 0;
+    } else if (!probing) {
+        emptyReadsOnUpdate++;
+    }
+
+    __atomic_sub_fetch(&inFlight[slot], 1, __ATOMIC_SEQ_CST);
+    return result;
+}
+
+static void reset(void) {
+    memset(pads, 0, sizeof(pads));
+    memset(updateCalls, 0, sizeof(updateCalls));
+    memset(probeCalls, 0, sizeof(probeCalls));
+    emptyReadsOnUpdate = 0;
+    overlaps = 0;
+}
+
+static int probe(XPoller *p, uint64_t nowUs) {
+    probing = 1;
+    int found = xpoll_probe(p, nowUs);
+    probing = 0;
+    return found;
+}
+
+static void update(XPoller *p, uint64_t nowUs, XPollResult results[XPOLL_MAX_SLOTS]) {
+    XPollRawState state;
+    xpoll_begin(p, nowUs);
+    for (int i = 0; i < XPOLL_MAX_SLOTS; i++)
+        results[i] = xpoll_slot(p, i, &state);
+}
+
+static void testSkipUnchanged(void) {
+    reset();
+    XPoller p;
+    XPollResult r[XPOLL_MAX_SLOTS];
+    xpoll_init(&p, fakeGetState);
+
+    pads[0].present = 1;
+    pads[0].packet = 7;
+
+    // The first probe finds the pad, the update picks it up
+    CHECK(probe(&p, 0) == 1);
+    update(&p, 1000, r);
+    CHECK(r[0] == XPOLL_CHANGED);
+    CHECK(r[1] == XPOLL_SKIPPED && r[2] == XPOLL_SKIPPED && r[3] == XPOLL_SKIPPED);
+
+    // Same packet: read but not decoded
+    for (int f = 0; f < 100; f++) {
+        update(&p, 2000 + f * 1000, r);
+        CHECK(r[0] == XPOLL_UNCHANGED);
+    }
+    pads[0].packet++;
+    update(&p, 200000, r);
+    CHECK(r[0] == XPOLL_CHANGED);
+
+    // A connected slot is the update's, the probe leaves it alone
+    for (uint64_t t = 0; t < 5000000; t += XPOLL_PROBE_INTERVAL_US)
+        probe(&p, 300000 + t);
+    CHECK(probeCalls[0] == 1);
+
+    CHECK(p.decodes == 2);
+    CHECK(p.skips == 100);
+    CHECK(p.calls == 102);
+    CHECK(updateCalls[0] == 102);
+    CHECK(updateCalls[1] + updateCalls[2] + updateCalls[3] == 0);
+}
+
+static void testBackoff(void) {
+    reset();
+    XPoller p;
+    XPollResult r[XPOLL_MAX_SLOTS];
+    xpoll_init(&p, fakeGetState);
+
+    // 10 s with nothing plugged in, probe every 50 ms and update every ms
+    for (uint64_t t = 0; t < 10000000; t += 1000) {
+        if (t % XPOLL_PROBE_INTERVAL_US == 0)
+            probe(&p, t);
+        update(&p, t, r);
+    }
+
+    // Probes at 0, 0.1, 0.3, 0.7, 1.5, 3.1, 5.1, 7.1, 9.1 s
+    for (int i = 0; i < XPOLL_MAX_SLOTS; i++)
+        CHECK(probeCalls[i] == 9);
+    CHECK(p.probes == 9 * XPOLL_MAX_SLOTS);
+    CHECK(p.calls == 0);
+    CHECK(emptyReadsOnUpdate == 0);
+}
+
+static void testReplug(void) {
+    reset();
+    XPoller p;
+    XPollResult r[XPOLL_MAX_SLOTS];
+    xpoll_init(&p, fakeGetState);
+
+    // Long empty, the backoff is at its 2 s cap
+    for (uint64_t t = 0; t < 10000000; t += XPOLL_PROBE_INTERVAL_US)
+        probe(&p, t);
+
+    pads[2].present = 1;
+    probe(&p, 11100000);
+    update(&p, 11100000, r);
+    CHECK(r[2] == XPOLL_CHANGED);
+
+    // Unplug: the update sees it, then the probe comes back after the short backoff
+    pads[2].present = 0;
+    update(&p, 12000000, r);
+    CHECK(r[2] == XPOLL_DISCONNECTED);
+    update(&p, 12001000, r);
+    CHECK(r[2] == XPOLL_SKIPPED);
+
+    int before = probeCalls[2];
+    probe(&p, 12050000);    // schedules the re-probe at 12.15 s
+    CHECK(probeCalls[2] == before);
+    pads[2].present = 1;
+    probe(&p, 12100000);
+    CHECK(probeCalls[2] == before);
+    CHECK(probe(&p, 12150000) == 1);
+    update(&p, 12151000, r);
+    CHECK(r[2] == XPOLL_CHANGED);
+
+    // Found, then gone before the update read it
+    pads[2].present = 0;
+    update(&p, 12200000, r);
+    CHECK(r[2] == XPOLL_DISCONNECTED);
+    pads[2].present = 1;
+    CHECK(probe(&p, 12250000) == 0);    // rearmed, due at 12.35 s
+    CHECK(probe(&p, 12350000) == 1);
+    pads[2].present = 0;
+    update(&p, 12351000, r);
+    CHECK(r[2] == XPOLL_EMPTY);
+    update(&p, 12352000, r);
+    CHECK(r[2] == XPOLL_SKIPPED);
+    CHECK(overlaps == 0);
+}
+
+// Probe thread for the concurrent test
+static volatile int stopProbe;
+
+static void *probeThread(void *arg) {
+    XPoller *p = arg;
+    uint64_t t = 0;
+    while (!stopProbe) {
+        xpoll_probe(p, t);
+        t += XPOLL_PROBE_INTERVAL_US;
+        sched_yield();
+    }
+    return NULL;
+}
+
+static void testConcurrent(void) {
+    reset();
+    XPoller p;
+    XPollResult r[XPOLL_MAX_SLOTS];
+    xpoll_init(&p, fakeGetState);
+
+    pthread_t thread;
+    stopProbe = 0;
+    widenCalls = 1;
+    pthread_create(&thread, NULL, probeThread, &p);
+
+    // Pads come and go under the update, the probe runs flat out on simulated time
+    uint32_t seed = 12345;
+    int changed = 0;
+    for (int f = 0; f < 20000; f++) {
+        seed = seed * 1664525u + 1013904223u;
+        int slot = (seed >> 16) % XPOLL_MAX_SLOTS;
+        if ((seed >> 8) % 64 == 0)
+            __atomic_store_n(&pads[slot].present, !pads[slot].present, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&pads[slot].packet, 1, __ATOMIC_RELAXED);
+
+        update(&p, (uint64_t)f * 1000, r);
+        for (int i = 0; i < XPOLL_MAX_SLOTS; i++)
+            changed += r[i] == XPOLL_CHANGED;
+
+        // Frame pacing, otherwise on one core the probe may never run before we're done
+        sched_yield();
+    }
+    stopProbe = 1;
+    pthread_join(thread, NULL);
+    widenCalls = 0;
+
+    CHECK(changed > 0);
+    CHECK(overlaps == 0);
+}
+
+int main(void) {
+    testSkipUnchanged();
+    testBackoff();
+    testReplug();
+    testConcurrent();
+    return checkReport("xinputPollerTest");
+}